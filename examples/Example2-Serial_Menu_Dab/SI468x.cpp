@@ -15,6 +15,25 @@ FlashSst26 flashSst26(PIN_FLASH_SLAVE_SELECT, SPI_FREQUENCY);
 
 //Global variables of device
 
+//Statistics of last readReply()
+replyStatistics_t replyStatistics = {0, 0, 0};
+
+//Statistics of last writePropertyValueList()
+propertyStatistics_t propertyStatistics = {0, 0, 0};
+
+//Property value lists match device
+bool propertyShadowValid = false;
+
+//Device was running at start of host
+bool warmStart = false;
+
+//Boot mode
+unsigned char bootMode = BOOT_HOST_LOAD;
+//Statistics of last firmware load
+loadStatistics_t loadStatistics = {0, 0, 0};
+//CRC32 of last image verified in flash memory for FLASH_LOAD, 0 if none
+unsigned long verifiedCrc32Firmware = 0;
+
 //Device power up arguments
 powerUpArguments_t powerUpArguments =
 {
@@ -98,7 +117,8 @@ powerUpArguments_t powerUpArguments =
 
 unsigned short propertyValueListDevice[NUM_PROPERTIES_DEVICE][2] =
 {
-  {INT_CTL_ENABLE,      1 << 7 | 1 << 6 | 1 << 5 | 1 << 4 | 1},//DEVNTIEN[13], CTSIEN[7],ERR_CMDIEN[6],DACQIEN[5],DSRVIEN[4],RSQIEN[3],ACFIEN[1], STCIEN[0]; default 0
+  {INT_CTL_ENABLE,      INT_SOURCES_REPLY},//DEVNTIEN[13], CTSIEN[7],ERR_CMDIEN[6],DACQIEN[5],DSRVIEN[4],RSQIEN[3],ACFIEN[1], STCIEN[0]; default 0
+  //only CTS and ERR, DSRV, DACQ and STC would hold INTB low until acknowledged and are polled
   {INT_CTL_REPEAT,      0},//default 0
 
   //Digital Output I2S
@@ -139,102 +159,317 @@ void deviceBegin()
 
   initalize();
 
-  reset();
+  //Device kept power during reset of host and runs DAB firmware, no reset and no firmware load
+  warmStart = probeWarmStart();
+
+  if (warmStart)
+  {
+    Serial.println(F("Warm Start"));
+  }
+  else
+  {
+    reset();
+    propertyShadowValid = false;
 
-  powerUp(powerUpArguments);
+    powerUp(powerUpArguments);
 
-  loadFirmware(addrBootloaderPatchFull, sizeBootloaderPatchFull); //FullPatch
+    //FullPatch
+    if (loadFirmware(addrBootloaderPatchFull, sizeBootloaderPatchFull, crc32BootloaderPatchFull) == false)
+    {
+      serialPrintSi468x::printError(11);
+    }
+  }
 
   readStatusRegister(statusRegister);
   serialPrintSi468x::printStatusRegister(statusRegister);
 
 }
 
+//Check if device runs DAB firmware of expected revision
+bool probeWarmStart()
+{
+  statusRegister_t statusRegister;
+  readStatusRegister(statusRegister);
+
+  //Application running without errors, device without power reads 0xff with cmdErr
+  if (statusRegister.state != 3 || statusRegister.cts == 0 || statusRegister.cmdErr == 1 || statusRegister.nonRecErr == 1)
+    return false;
+
+  //DAB
+  if (readSystemState() != 2) return false;
+
+  //Revision of DAB firmware in flash memory
+  firmwareInformation_t firmwareInformation;
+  readFirmwareInformation(firmwareInformation);
+
+  return firmwareInformation.revisionNumberMajor == revisionFirmwareDabMajor &&
+         firmwareInformation.revisionNumberMinor == revisionFirmwareDabMinor &&
+         firmwareInformation.revisionNumberBuild == revisionFirmwareDabBuild;
+}
+
+//Load firmware image with bootMode, host relay as fallback
+bool loadFirmwareImage(unsigned long addressFirmware, unsigned long sizeFirmware, unsigned long crc32Firmware)
+{
+  bool loadResult = true;
+
+  unsigned long start = millis();
+
+  //no packages with FLASH_LOAD
+  loadStatistics.packageSize = 0;
+
+  //Device loads firmware itself, image does not pass host and is verified once per image
+  if (bootMode == BOOT_FLASH_LOAD && crc32Firmware != 0 && crc32Firmware != verifiedCrc32Firmware)
+  {
+    //Corrupted image, do not FLASH_LOAD
+    if (verifyFirmware(addressFirmware, sizeFirmware, crc32Firmware) == false)
+    {
+      loadStatistics.duration = millis() - start;
+      loadStatistics.throughput = 0;
+      return false;
+    }
+    verifiedCrc32Firmware = crc32Firmware;
+  }
+
+  if (bootMode == BOOT_FLASH_LOAD)
+  {
+    if (loadFirmwareFlash(addressFirmware) == false)
+    {
+      //FLASH_LOAD not wired or failed, use host relay from now on
+      bootMode = BOOT_HOST_LOAD;
+    }
+  }
+
+  //Host relays firmware
+  if (bootMode == BOOT_HOST_LOAD)
+  {
+    loadResult = loadFirmware(addressFirmware, sizeFirmware, crc32Firmware);
+  }
+
+  loadStatistics.duration = millis() - start;
+
+  //Bytes per second
+  if (loadStatistics.duration != 0)
+    loadStatistics.throughput = sizeFirmware * 1000UL / loadStatistics.duration;
+  else
+    loadStatistics.throughput = 0;
+
+  serialPrintSi468x::printBootInformation(bootMode, loadStatistics);
+
+  return loadResult;
+}
+
+//Load and boot DAB firmware, FLASH_LOAD falls back to host relay if device does not boot
+bool bootFirmwareDab()
+{
+  bool loaded = loadFirmwareImage(addrFirmwareDab, sizeFirmwareDab, crc32FirmwareDab);
+  if (loaded && boot()) return true;
+
+  //Without secondary SPI bus FLASH_LOAD gets CTS too, but BOOT fails
+  if (loaded && bootMode == BOOT_FLASH_LOAD)
+  {
+    bootMode = BOOT_HOST_LOAD;
+
+    //Start again with patch
+    reset();
+    powerUp(powerUpArguments);
+    loaded = loadFirmware(addrBootloaderPatchFull, sizeBootloaderPatchFull, crc32BootloaderPatchFull) &&
+             loadFirmwareImage(addrFirmwareDab, sizeFirmwareDab, crc32FirmwareDab);
+    if (loaded && boot()) return true;
+  }
+
+  //Corrupted image or boot failed
+  serialPrintSi468x::printError(loaded ? 12 : 11);
+  return false;
+}
+
+//Device loads firmware from flash memory over secondary SPI bus
+bool loadFirmwareFlash(unsigned long addressFirmware)
+{
+  //no copy over host and no HOST_LOAD packages
+  unsigned char buf[4] = {0xff, 0xff, 0xff, 0xff};
+
+  //prepare circuit to load firmware, patch must be loaded before
+  loadInit();
+
+  flashLoad(addressFirmware);
+
+  //FLASH_LOAD is complete with CTS
+  return readReply(buf, sizeof(buf), TIMEOUT_FLASH_LOAD);
+}
+
 //Loads data from Flash Memory into host and than into device
-void loadFirmware(unsigned long addressFirmware, unsigned long sizeFirmware)
+bool loadFirmware(unsigned long addressFirmware, unsigned long sizeFirmware, unsigned long crc32Firmware)
 {
-  //to measure time to load firmware
-  //#define SPEED
-#ifdef SPEED
-  uint32_t start = millis();
-  uint32_t zeit;
-#endif
   //time for firmware 1683ms @ package 0x100, 8MHz
   //time for firmware 1530ms @ package 0x300, 8MHz
 
   //Size of transferbuffer
   //Max Package size of tuner circuit 0x1000 and modulo 4
-  //Defines the size of packages load from flash to Arduino to device.Careful because of RAM effect
-  //Tested with
-  //0x100 ok
-  //0x150 ok
-  //0x200 ok
-  //0x300 ok
-  //0x400 nok memory leak
-  uint16_t lenData = 0x100;
-
-  //transferbuffer
-  uint8_t data[lenData];
+  //Defines the size of packages load from flash to Arduino to device. Buffer is on the stack,
+  //0x400 failed on UNO with fixed size because stack ran into heap. Size is taken from free RAM now.
+  uint16_t lenData = getLoadPackageSize();
 
-  //If not initalized error in loading. Device reads commands ? every 2nd time after POR.
-  for (uint32_t i = 0; i < lenData; i++) data[i] = 0xff;
+  //Package on stack would run into heap
+  if (lenData == 0)
+  {
+    serialPrintSi468x::printError(10);
+    loadStatistics.packageSize = 0;
+    return false;
+  }
 
-  //Calculate modulo to get even number
-  uint16_t modulo = sizeFirmware % lenData;
+  //Flash memory and tuner circuit share one SPI bus, so reading flash and HOST_LOAD can not overlap.
+  //Flash pages are read back to back into one big package to reduce the number of HOST_LOAD commands.
+  uint8_t data[lenData];
 
-  //How many packages ?
-  const uint32_t packages = (sizeFirmware - modulo) / lenData;
-  /*
-    Serial.print(F("Size:"));
-    Serial.print(sizeFirmware);
-    Serial.print(F("\tPackages:"));
-    Serial.print(packages);
-    Serial.print(F("\tModulo:"));
-    Serial.println(modulo);
-  */
+  //If not initalized error in loading. Device reads commands ? every 2nd time after POR.
+  for (uint16_t i = 0; i < lenData; i++) data[i] = 0xff;
 
   //prepare circuit to load firmware
   loadInit();
 
+  unsigned long offset = 0;
+
+  //CRC32 over image while streaming
+  unsigned long crc32 = 0;
+
   //cycle packages
-  for (uint32_t i = 0 ; i < packages; i++)
+  while (offset < sizeFirmware)
+  {
+    //last package is maybe not complete
+    uint16_t lenPackage = lenData;
+    if (sizeFirmware - offset < lenData) lenPackage = sizeFirmware - offset;
+
+    //Read data from flash pagewise, readData works with 0x100
+    for (uint16_t page = 0; page < lenPackage; page += FLASH_PAGE_SIZE)
+    {
+      uint16_t lenPage = FLASH_PAGE_SIZE;
+      if (lenPackage - page < FLASH_PAGE_SIZE) lenPage = lenPackage - page;
+      readFlash(addressFirmware + offset + page, &data[page], lenPage);
+    }
+
+    offset += lenPackage;
+
+    crc32 = updateCrc32(crc32, data, lenPackage);
+
+    //fill up last package with 0xff to modulo 4
+    while (lenPackage % 4 != 0) data[lenPackage++] = 0xff;
+
+    //Write data to tuner, package is lost if device is not ready
+    if (hostLoad(data, lenPackage) == false)
+    {
+      loadStatistics.packageSize = lenData;
+      return false;
+    }
+  }
+
+  loadStatistics.packageSize = lenData;
+
+  //Corrupted image, do not BOOT
+  if (crc32Firmware != 0 && crc32 != crc32Firmware)
+  {
+    return false;
+  }
+  return true;
+}
+
+//Verify firmware image in flash memory without loading device
+bool verifyFirmware(unsigned long addressFirmware, unsigned long sizeFirmware, unsigned long crc32Firmware)
+{
+  uint8_t data[FLASH_PAGE_SIZE];
+
+  unsigned long crc32 = 0;
+
+  for (unsigned long offset = 0; offset < sizeFirmware; offset += FLASH_PAGE_SIZE)
   {
-    //initalize dataBuffer[] with 0xff
-    //for (uint16_t j = 0; j < lenData; j++) data[j] = 0xff;
+    uint16_t lenPage = FLASH_PAGE_SIZE;
+    if (sizeFirmware - offset < FLASH_PAGE_SIZE) lenPage = sizeFirmware - offset;
+
+    readFlash(addressFirmware + offset, data, lenPage);
+
+    crc32 = updateCrc32(crc32, data, lenPage);
+  }
+
+  return crc32 == crc32Firmware;
+}
 
-    //does not work
-    //uint32_t address = addressFirmware + (i * lenData);
-    //Serial.println(address, HEX);
-    //flashSst26.readData(addressFirmware, data, lenData);
+//CRC32 (IEEE 802.3, zlib) with 4 bit table to save flash memory
+const uint32_t crc32Table[16] PROGMEM =
+{
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+//Continue CRC32 with next chunk of data, start with crc32 = 0
+unsigned long updateCrc32(unsigned long crc32, const unsigned char data[], unsigned short len)
+{
+  //32 bit register, unsigned long has 64 bit on host
+  uint32_t crc = ~(uint32_t) crc32;
 
-    //Read data from flash
-    flashSst26.readData(addressFirmware + (i * lenData), data, lenData);
-    //i increments if lenData = 0x200;?
-    //Serial.println(i);
-    //Write data to tuner
-    hostLoad(data, lenData);
+  for (unsigned short i = 0; i < len; i++)
+  {
+    crc = (crc >> 4) ^ pgm_read_dword(&crc32Table[(crc ^ data[i]) & 0x0F]);
+    crc = (crc >> 4) ^ pgm_read_dword(&crc32Table[(crc ^ (data[i] >> 4)) & 0x0F]);
   }
 
+  return ~crc;
+}
+
+//Size of HOST_LOAD package from free RAM, 0 if RAM_RESERVE_LOAD can not be kept
+unsigned short getLoadPackageSize()
+{
+  unsigned short freeRam = getFreeRam();
 
-  //last package is maybe not complete - fill up with 0xff
-  if (modulo != 0)
+  //Keep RAM for stack of called functions, smaller packages divide a flash page
+  if (freeRam < RAM_RESERVE_LOAD + FLASH_PAGE_SIZE)
   {
-    //initalize dataBuffer[] with 0xff only for rest
-    for (uint16_t j = 0; j < lenData; j++) data[j] = 0xff;
-    //Read data from flash
-    flashSst26.readData(addressFirmware + packages * lenData, data, modulo);
-    //Write data to tuner
-    hostLoad(data, lenData);
+    if (freeRam < RAM_RESERVE_LOAD + MIN_LOAD_PACKAGE_SIZE) return 0;
+    return MIN_LOAD_PACKAGE_SIZE;
   }
 
-#ifdef SPEED
-  zeit = millis() - start;
-  Serial.print(F("Zeit:\t"));
-  Serial.println(zeit);
+  //multiple of flash page size
+  unsigned short lenData = (freeRam - RAM_RESERVE_LOAD) / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE;
+
+  //Max Package size of HOST_LOAD
+  if (lenData > MAX_LOAD_PACKAGE_SIZE) lenData = MAX_LOAD_PACKAGE_SIZE;
+
+  return lenData;
+}
+
+//Free RAM between heap and stack
+unsigned short getFreeRam()
+{
+#if !defined(__AVR__)
+  //No heap/stack layout of AVR, allow biggest package
+  return MAX_LOAD_PACKAGE_SIZE + RAM_RESERVE_LOAD;
+#else
+  extern unsigned int __heap_start;
+  extern unsigned int *__brkval;
+  //test variable created on stack
+  unsigned int newVariable = 0;
+
+  return (unsigned int) &newVariable - (__brkval == 0 ? (unsigned int) &__heap_start : (unsigned int) __brkval);
 #endif
 }
 
-//Write command and argument
+//Read data from flash memory, only access of driver to flash memory
+void readFlash(unsigned long address, unsigned char data[], unsigned short len)
+{
+  flashSst26.readData(address, data, len);
+}
+
+//Write data to flash memory within one page
+void writeFlash(unsigned long address, unsigned char data[], unsigned short len)
+{
+  flashSst26.writePage(address, data, len);
+}
+
+//Erase sector of flash memory
+void eraseFlash(unsigned long address)
+{
+  flashSst26.eraseSector(address);
+}
+
+//Write command and argument, only access of driver to SPI of device together with writeCommand()
 void writeCommandArgument(unsigned char cmd[], unsigned long lenCmd, unsigned char arg[], unsigned long lenArg)
 {
   //no arguments
@@ -294,6 +529,13 @@ void powerDown(bool enable, unsigned char resetPin)
 }
 
 
+//Interrupt of device asserted
+bool readInterrupt()
+{
+  //INTB is active low
+  return digitalRead(PIN_DEVICE_INTERRUPT) == LOW;
+}
+
 //Read status register
 void readStatusRegister(statusRegister_t& statusRegister)
 {
@@ -320,26 +562,189 @@ void readStatusRegister(statusRegister_t& statusRegister)
 //Read properties and return a pointer to a 2dim list of id and value
 unsigned short (*readPropertyValueList(unsigned short propertyValueList[][2], unsigned char numberProperties))[2]
 {
+  unsigned short values[MAX_PROPERTY_COUNT];
+
   //read from device
-  for (uint8_t i = 0; i < numberProperties; i++)
+  for (uint8_t i = 0; i < numberProperties;)
   {
-    //readPropertyValue() returns the value if given the right id
-    propertyValueList[i][1] = readPropertyValue(propertyValueList[i][0]);
+    //group contiguous ids like 0xB200...0xB204 to read them with one GET_PROPERTY
+    uint8_t count = countContiguousProperties(propertyValueList, numberProperties, i);
+
+    readPropertyValues(propertyValueList[i][0], values, count);
+
+    for (uint8_t j = 0; j < count; j++)
+    {
+      propertyValueList[i + j][1] = values[j];
+    }
+
+    i += count;
   }
   return propertyValueList;
 }
 
-//Writes 2 dimensional property value list with numberProperties to device
-void writePropertyValueList(unsigned short propertyValueList[][2], unsigned char numberProperties)
+//Number of contiguous ids in list starting at first, max MAX_PROPERTY_COUNT
+unsigned char countContiguousProperties(unsigned short propertyValueList[][2], unsigned char numberProperties, unsigned char first)
+{
+  unsigned char count = 1;
+  while (first + count < numberProperties && count < MAX_PROPERTY_COUNT &&
+         propertyValueList[first + count][0] == (unsigned short)(propertyValueList[first][0] + count))
+  {
+    count++;
+  }
+  return count;
+}
+
+//Writes 2 dimensional property value list with numberProperties to device, skips values already set
+void writePropertyValueList(unsigned short propertyValueList[][2], unsigned char numberProperties, unsigned char propertyState)
+{
+  unsigned long start = millis();
+
+  propertyStatistics.written = 0;
+  propertyStatistics.skipped = 0;
+
+  unsigned short values[MAX_PROPERTY_COUNT];
+
+  for (uint8_t i = 0; i < numberProperties;)
+  {
+    uint8_t count = countContiguousProperties(propertyValueList, numberProperties, i);
+
+    //actual values of device
+    if (propertyState == PROPERTIES_READ)
+    {
+      readPropertyValues(propertyValueList[i][0], values, count);
+    }
+
+    for (uint8_t j = 0; j < count; j++)
+    {
+      unsigned short id = propertyValueList[i + j][0];
+      unsigned short value = propertyValueList[i + j][1];
+
+      bool skip = false;
+      if (propertyState == PROPERTIES_DEFAULT)
+      {
+        unsigned short valueDefault;
+        skip = readPropertyDefault(id, valueDefault) && valueDefault == value;
+      }
+      else if (propertyState == PROPERTIES_READ)
+      {
+        skip = values[j] == value;
+      }
+
+      if (skip)
+      {
+        propertyStatistics.skipped++;
+      }
+      else
+      {
+        //readReply() waits for CTS, so the next write follows immediately
+        writePropertyValue(id, value);
+        propertyStatistics.written++;
+      }
+    }
+
+    i += count;
+  }
+
+  propertyStatistics.duration = millis() - start;
+}
+
+//Default values of device after BOOT
+const unsigned short propertyDefaults[][2] PROGMEM =
+{
+  {INT_CTL_ENABLE, 0},
+  {INT_CTL_REPEAT, 0},
+  {DIGITAL_IO_OUTPUT_SELECT, 0},
+  {DIGITAL_IO_OUTPUT_SAMPLE_RATE, 48000},
+  {DIGITAL_IO_OUTPUT_FORMAT, 0x1800},
+  {DIGITAL_IO_OUTPUT_FORMAT_OVERRIDES_1, 0},
+  {DIGITAL_IO_OUTPUT_FORMAT_OVERRIDES_2, 0},
+  {DIGITAL_IO_OUTPUT_FORMAT_OVERRIDES_3, 0},
+  {DIGITAL_IO_OUTPUT_FORMAT_OVERRIDES_4, 0},
+  {AUDIO_ANALOG_VOLUME, 63},
+  {AUDIO_MUTE, 0},
+  {AUDIO_OUTPUT_CONFIG, 0},
+  {PIN_CONFIG_ENABLE, 0x0001},
+  {WAKE_TONE_ENABLE, 0},
+  {WAKE_TONE_PERIOD, 250},
+  {WAKE_TONE_FREQ, 750},
+  {WAKE_TONE_AMPLITUDE, 8},
+
+  {DAB_TUNE_FE_VARM, 0},
+  {DAB_TUNE_FE_VARB, 0},
+  {DAB_TUNE_FE_CFG, 0x0001},
+  {DIGITAL_SERVICE_INT_SOURCE, 0},
+  {DIGITAL_SERVICE_RESTART_DELAY, 200},
+  {DAB_DIGRAD_INTERRUPT_SOURCE, 0},
+  {DAB_DIGRAD_RSSI_HIGH_THRESHOLD, 127},
+  {DAB_DIGRAD_RSSI_LOW_THRESHOLD, 0xFF80},
+  {DAB_VALID_RSSI_TIME, 30},
+  {DAB_VALID_RSSI_THRESHOLD, 12},
+  {DAB_VALID_ACQ_TIME, 2000},
+  {DAB_VALID_SYNC_TIME, 1200},
+  {DAB_VALID_DETECT_TIME, 35},
+  {DAB_EVENT_INTERRUPT_SOURCE, 0},
+  {DAB_EVENT_MIN_SVRLIST_PERIOD, 10},
+  {DAB_EVENT_MIN_SVRLIST_PERIOD_RECONFIG, 10},
+  {DAB_EVENT_MIN_FREQINFO_PERIOD, 5},
+  {DAB_XPAD_ENABLE, 1},
+  {DAB_DRC_OPTION, 0},
+  {DAB_CTRL_DAB_MUTE_ENABLE, 1},
+  {DAB_CTRL_DAB_MUTE_SIGNAL_LEVEL_THRESHOLD, 98},
+  {DAB_CTRL_DAB_MUTE_WIN_THRESHOLD, 1000},
+  {DAB_CTRL_DAB_UNMUTE_WIN_THRESHOLD, 1500},
+  {DAB_CTRL_DAB_MUTE_SIGLOSS_THRESHOLD, 6},
+  {DAB_CTRL_DAB_MUTE_SIGLOW_THRESHOLD, 9},
+  {DAB_ANNOUNCEMENT_ENABLE, 0x07FF}
+};
+
+//Default value of property after BOOT, false if unknown
+bool readPropertyDefault(unsigned short id, unsigned short& value)
+{
+  for (uint8_t i = 0; i < sizeof(propertyDefaults) / sizeof(propertyDefaults[0]); i++)
+  {
+    if (pgm_read_word(&propertyDefaults[i][0]) == id)
+    {
+      value = pgm_read_word(&propertyDefaults[i][1]);
+      return true;
+    }
+  }
+  return false;
+}
+
+//Pointer to value of id in property value lists of device and DAB, nullptr if not in lists
+unsigned short* findPropertyShadow(unsigned short id)
 {
-  for (uint8_t i = 0; i < numberProperties; i++)
+  for (uint8_t i = 0; i < NUM_PROPERTIES_DEVICE; i++)
+  {
+    if (propertyValueListDevice[i][0] == id) return &propertyValueListDevice[i][1];
+  }
+  for (uint8_t i = 0; i < NUM_PROPERTIES_DAB; i++)
   {
-    writePropertyValue(propertyValueList[i][0], propertyValueList[i][1]);
+    if (propertyValueListDab[i][0] == id) return &propertyValueListDab[i][1];
   }
+  return nullptr;
+}
+
+//Value of property from shadow without SPI, reads device if not in shadow
+unsigned short readPropertyValueShadow(unsigned short id)
+{
+  unsigned short* shadow = findPropertyShadow(id);
+
+  if (propertyShadowValid && shadow != nullptr) return *shadow;
+
+  return readPropertyValue(id);
+}
+
+//Read property value lists from device into shadow
+void syncPropertyShadow()
+{
+  readPropertyValueList(propertyValueListDevice, NUM_PROPERTIES_DEVICE);
+  readPropertyValueList(propertyValueListDab, NUM_PROPERTIES_DAB);
+  propertyShadowValid = true;
 }
 
 //0x00 RD_REPLY Read answer of device
-bool readReply(unsigned char reply[], unsigned long len)
+bool readReply(unsigned char reply[], unsigned long len, unsigned long timeout)
 {
   //result of reading
   bool readResult = false;
@@ -347,49 +752,67 @@ bool readReply(unsigned char reply[], unsigned long len)
   //CMD
   unsigned char cmd[1] = {READ_REPLY};
 
-  //retry until maxRetry
-  for (unsigned char retry = 0; retry < MAX_RETRY; retry++)
-  {
-    //init reply to 0xff
-    for (unsigned char i = 0; i < len; i++) reply[i] = 0xff;
+  unsigned long start = micros();
+  //first poll immediately
+  unsigned long lastPoll = start - DURATION_POLL_REPLY;
 
-    ///wait for device - to be improved
-    //delayMicroseconds(DURATION_REPLY);
-    delayMicroseconds(DURATION_REPLY);
+  //INTB is released by the command, CTS asserts it again, an edge starts a poll
+  bool lastInterrupt = false;
 
-    writeCommandArgument(cmd, sizeof(cmd), reply, len);
+  replyStatistics.polls = 0;
+  replyStatistics.interrupt = 0;
 
-    //Clear to send and no error then break loop
-    if ((((reply[0] >> 7) & 1) == 1) && (((reply[0] >> 6) & 1) == 0))
-    {
-      readResult = true;
-      break;
-    }
-    //error
-    else if ((reply[0] >> 6 & 1) == 1)
+  //Pin 6 is no external interrupt pin of UNO, so INTB is polled in short steps
+  while (true)
+  {
+    //INTB held low by another source gives no edge, CTS bit is checked at next poll
+    bool interrupt = readInterrupt();
+    bool edge = interrupt && !lastInterrupt;
+    lastInterrupt = interrupt;
+
+    //CTS signaled by INTB or time for next poll
+    if (edge || micros() - lastPoll >= DURATION_POLL_REPLY)
     {
-      //if cmdErr read byte 5 of reply
-      unsigned char errBuf[5] = {0xff, 0xff, 0xff, 0xff, 0xff};
-      writeCommandArgument(cmd, sizeof(cmd), errBuf, sizeof(errBuf));
-      serialPrintSi468x::printResponseHex(errBuf, sizeof(errBuf));
-      //statusRegister.cmdErrCode = errBuf[4];
-      readResult = false;
-      break;
+      lastPoll = micros();
+
+      //init reply to 0xff
+      for (unsigned long i = 0; i < len; i++) reply[i] = 0xff;
+
+      writeCommandArgument(cmd, sizeof(cmd), reply, len);
+      replyStatistics.polls++;
+
+      //Clear to send and no error then break loop
+      if ((((reply[0] >> 7) & 1) == 1) && (((reply[0] >> 6) & 1) == 0))
+      {
+        replyStatistics.interrupt = edge;
+        readResult = true;
+        break;
+      }
+      //error, valid with CTS, a command sent before would be dropped
+      else if ((reply[0] >> 7 & 1) == 1)
+      {
+        //if cmdErr read byte 5 of reply
+        unsigned char errBuf[5] = {0xff, 0xff, 0xff, 0xff, 0xff};
+        writeCommandArgument(cmd, sizeof(cmd), errBuf, sizeof(errBuf));
+        serialPrintSi468x::printResponseHex(errBuf, sizeof(errBuf));
+        //statusRegister.cmdErrCode = errBuf[4];
+        readResult = false;
+        break;
+      }
     }
 
-    //too many reads
-    else if (retry == MAX_RETRY - 1)
+    //timeout
+    if (micros() - start >= timeout)
     {
       readResult = false;
       break;
     }
 
-    else
-    {
-      readResult = false;
-    }
+    delayMicroseconds(DURATION_POLL_INTERRUPT);
   }
 
+  replyStatistics.duration = micros() - start;
+
   return readResult;
 }
 
@@ -418,17 +841,21 @@ void powerUp(powerUpArguments_t powerUpArguments)
   cmd[15] = 0;                                      //Arg15 0
 
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(DURATION_POWER_UP);
+  //CTS after tPOWER_UP, CTSIEN of ARG1 signals it on INTB
   readReply(buf, sizeof(buf));
+
+  //device starts with frequency table of firmware
+  frequencyTableHeader.valid = 0;
 }
 
-//0x04 HOST_LOAD Loads an image from HOST over command interface
-void hostLoad(unsigned char package[], unsigned short len)
+//0x04 HOST_LOAD Loads an image from HOST over command interface, true if package was accepted
+bool hostLoad(unsigned char package[], unsigned short len)
 {
   //Validity ? Maximal 4096 bytes of application image
-  if (len > 0x1000) return;
+  if (len > 0x1000) return false;
 
   unsigned char cmd[4];
+  unsigned char buf[4] = {0xff, 0xff, 0xff, 0xff};
 
   cmd[0] = HOST_LOAD;
   cmd[1] = 0x00; //ARG1
@@ -436,6 +863,9 @@ void hostLoad(unsigned char package[], unsigned short len)
   cmd[3] = 0x00; //ARG3
 
   writeCommandArgument(cmd, sizeof(cmd), package, len);
+
+  //Next command before CTS would be dropped with CMDOFERR, false on ERR
+  return readReply(buf, sizeof(buf));
 }
 
 //0x05 FLASH_LOAD Loads an image from external FLASH over secondary SPI bus
@@ -467,14 +897,15 @@ void loadInit()
   cmd[0] = LOAD_INIT;
   cmd[1] = 0x00;
 
-  ///wait for device - to be improved
-  delayMicroseconds(DURATION_LOAD_INIT);
+  unsigned char buf[4] = {0xff, 0xff, 0xff, 0xff};
+
+  //device is ready for HOST_LOAD or FLASH_LOAD with CTS
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(DURATION_LOAD_INIT);
+  readReply(buf, sizeof(buf));
 }
 
 //0x07 BOOT Boots the image currently loaded in RAM
-void boot()
+bool boot()
 {
   unsigned char cmd[2];
 
@@ -483,11 +914,27 @@ void boot()
 
   writeCommand(cmd, sizeof(cmd));
 
-  //wait for device - to be improved
-  for (uint8_t i = 0; i < 30; i++)
+  //Boot time 63ms at analog FM, 198ms at DAB
+  //wait for PUP_STATE until timeout instead of fixed 300ms
+  statusRegister_t statusRegister;
+  unsigned long start = micros();
+
+  do
   {
-    delayMicroseconds (DURATION_BOOT);
+    //waits for CTS on INTB or polls
+    readStatusRegister(statusRegister);
+
+    //Application running
+    if (statusRegister.state == 3 && statusRegister.cts == 1) return true;
+
+    //Non recoverable error
+    if (statusRegister.nonRecErr == 1) return false;
+
+    delayMicroseconds(DURATION_POLL_REPLY);
   }
+  while (micros() - start < TIMEOUT_BOOT);
+
+  return false;
 }
 
 //0x08 GET_PART_INFO Get Device Part Info
@@ -621,29 +1068,46 @@ void writePropertyValue(unsigned short id, unsigned short value)
   writeCommand(cmd, sizeof(cmd));
 
   readReply(buf, sizeof(buf));
+
+  //write through to shadow
+  unsigned short* shadow = findPropertyShadow(id);
+  if (shadow != nullptr) *shadow = value;
 }
 
 //0x14 GET_PROPERTY Retrieve the value of a property
 unsigned short readPropertyValue(unsigned short id)
 {
-  unsigned char buf[6] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
-
   unsigned short propertyValue = 0xffff;
 
+  readPropertyValues(id, &propertyValue, 1);
+
+  return propertyValue;
+}
+
+//0x14 GET_PROPERTY Retrieve the values of count properties with contiguous ids starting at id
+void readPropertyValues(unsigned short id, unsigned short values[], unsigned char count)
+{
+  //Validity ?
+  if (count == 0 || count > MAX_PROPERTY_COUNT) return;
+
+  //4 status bytes + 2 bytes per property
+  unsigned char buf[4 + 2 * MAX_PROPERTY_COUNT];
+  for (unsigned char i = 0; i < sizeof(buf); i++) buf[i] = 0xff;
+
   unsigned char cmd[4];
   cmd[0] = GET_PROPERTY;
-  cmd[1] = 1;//count = 1
+  cmd[1] = count;
   cmd[2] = id & 0xff;
   cmd[3] = id >> 8 & 0xff;
 
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(DURATION_PROPERTY);
-  delayMicroseconds(DURATION_PROPERTY);
-  readReply(buf, sizeof(buf));
-
-  propertyValue = (unsigned short)buf[5] << 8 | buf[4];
+  //readReply() waits for CTS
+  readReply(buf, 4 + 2 * count);
 
-  return propertyValue;
+  for (unsigned char i = 0; i < count; i++)
+  {
+    values[i] = (unsigned short)buf[5 + 2 * i] << 8 | buf[4 + 2 * i];
+  }
 }
 
 //0x15 WRITE_STORAGE Writes data to the on board storage area at a specified offset
@@ -699,7 +1163,6 @@ unsigned short readRssi()
   cmd[1] = 0;
 
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(10000);
   readReply(buf, sizeof(buf));
 
   rssi = buf[5] << 8 | buf[4];
@@ -711,14 +1174,41 @@ unsigned short readRssi()
 
 //Global variables DAB definitions
 
-//Ensemble header with pointer to service list - dynamic memory allocation
-ensembleHeader_t ensembleHeader = {0, 0, 0, 0, 0, nullptr};
+//Ensemble header, services are in ensembleArena
+ensembleHeader_t ensembleHeader = {0, 0, 0, 0, 0};
+
+//Services and components of ensemble in one fixed block, no heap
+ensembleArena_t ensembleArena;
+
+//Key of parsed ensemble
+ensembleCache_t ensembleCache = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+//Service directory in flash
+serviceDirectory_t serviceDirectory = {};
+
+//Difference of service list after last reconfiguration
+ensembleDiff_t ensembleDiff = {0, 0, 0, 0};
+
+//Allocation of CIF of parsed ensemble
+cifMap_t cifMap;
 
-//Frequency table - dynamic memory allocation
-frequencyTableHeader_t frequencyTableHeader = {0, nullptr};
+//Last tuneIndex()
+tuneStatistics_t tuneStatistics = {0, 0, 0, 0};
+
+//Result of last scanIndices()
+scanStatistics_t scanStatistics = {0, 0, 0, 0, 0};
+
+//Running scan or seek
+scanJob_t scanJob;
+
+//Weights of score of scanned indices, CNR and SNR count most for a stable ensemble
+qualityWeights_t qualityWeights = {1, 2, 2, 1, 0};
+
+//Frequency table - cache of device without heap
+frequencyTableHeader_t frequencyTableHeader = {};
 
 //valid indices after bandscan
-indexListHeader_t indexListHeader = {0, nullptr};
+indexListHeader_t indexListHeader = {};
 
 
 //Actual index
@@ -856,12 +1346,15 @@ unsigned short propertyValueListDab[NUM_PROPERTIES_DAB][2] =
 
 void dabBegin()
 {
-  loadFirmware(addrFirmwareDab, sizeFirmwareDab);//DAB Firmware
-
-  //Print device status information
-  //serialPrintSi468x::devicePrintStatus(deviceGetStatus());
-  //Boot device
-  boot();
+  //DAB firmware is running after warm start, only properties and tune
+  if (warmStart == false)
+  {
+    //DAB Firmware
+    //Print device status information
+    //serialPrintSi468x::devicePrintStatus(deviceGetStatus());
+    //Boot device
+    if (bootFirmwareDab() == false) return;
+  }
 
   statusRegister_t statusRegister;
   readStatusRegister(statusRegister);
@@ -869,20 +1362,43 @@ void dabBegin()
   //Print device status information
   serialPrintSi468x::printStatusRegister(statusRegister);
 
+  //Properties of running device are unknown after warm start, default after boot
+  unsigned char propertyState = PROPERTIES_DEFAULT;
+  if (warmStart) propertyState = PROPERTIES_READ;
+
   //Set device properties
-  writePropertyValueList(propertyValueListDevice, NUM_PROPERTIES_DEVICE);
+  writePropertyValueList(propertyValueListDevice, NUM_PROPERTIES_DEVICE, propertyState);
+  serialPrintSi468x::printPropertyStatistics(propertyStatistics);
 
   //Print system state
   serialPrintSi468x::printSystemState(readSystemState());
 
 
   //Set DAB properties
-  writePropertyValueList(propertyValueListDab, NUM_PROPERTIES_DAB);
+  writePropertyValueList(propertyValueListDab, NUM_PROPERTIES_DAB, propertyState);
+  serialPrintSi468x::printPropertyStatistics(propertyStatistics);
+
+  //Property value lists are written, use them as shadow
+  propertyShadowValid = true;
+
+  //Services of ensembles parsed before
+  beginServiceDirectory();
+
+  //Index of last session, else inital index
+  readEnsembleSnapshotIndex(index);
 
   //Tunes DAB inital index
   tuneIndex(index);
-  //Starts inital audio service
-  startService(serviceId, componentId);
+
+  //Ensemble of last session, next/previous work before service list is available
+  bool restored = restoreEnsembleSnapshot();
+
+  //Starts inital audio service, first audio service of snapshot if it is not in there
+  unsigned char rank;
+  if (restored && !findService(ensembleHeader, serviceId, rank)) startFirstService(serviceId, componentId);
+  else startService(serviceId, componentId);
+
+  if (restored) serialPrintSi468x::dabPrintEnsembleCache(ensembleCache);
 
   //readServiceInformation(dabServiceInformation, serviceId);
   //writeTextField(dabServiceInformation.serviceLabel);
@@ -910,8 +1426,8 @@ void startService(const unsigned long &serviceId, const unsigned long &component
   arg[10] = componentId >> 24 & 0xFF;
 
   writeCommandArgument(cmd, sizeof(cmd), arg, sizeof(arg));
-  for (uint8_t j = 0; j < 10; j++) delayMicroseconds(DURATION_STOP_START_SERVICE);
-  readReply(buf, sizeof(buf));
+  //CTS as soon as service is started
+  readReply(buf, sizeof(buf), TIMEOUT_START_SERVICE);
 }
 
 void stopService(const unsigned long &serviceId, const unsigned long &componentId, const unsigned char serviceType)
@@ -935,8 +1451,7 @@ void stopService(const unsigned long &serviceId, const unsigned long &componentI
   arg[10] = componentId >> 24 & 0xFF;
 
   writeCommandArgument(cmd, sizeof(cmd), arg, sizeof(arg));
-  delayMicroseconds(DURATION_STOP_START_SERVICE);
-  readReply(buf, sizeof(buf));
+  readReply(buf, sizeof(buf), TIMEOUT_START_SERVICE);
 }
 
 //0x84 GET_DIGITAL_SERVICE_DATA Gets a block of data associated with one of the enabled data components of a digital services*/
@@ -976,8 +1491,6 @@ void readServiceData(serviceData_t& serviceData, unsigned char statusOnly, unsig
   cmd[1] = ((statusOnly  & 1 ) << 4) | (ack & 1);
 
   writeCommand(cmd, sizeof(cmd));
-
-  delayMicroseconds(10000);
   readReply(buf, sizeof(buf));
 
   serviceData.errorInterrupt     =  buf[4] >> 2 & 1;
@@ -1100,9 +1613,14 @@ void getEnsembleHeader(ensembleHeader_t &ensembleHeader, unsigned char serviceTy
   for (uint8_t i = 0; i < len; i++) buf[i] = 0xff;
 
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(10000);
   readReply(buf, sizeof(buf));
 
+  parseEnsembleHeader(ensembleHeader, buf);
+}
+
+//Decode list header of GET_DIGITAL_SERVICE_LIST reply, buf[0...3] is status
+void parseEnsembleHeader(ensembleHeader_t &ensembleHeader, const uint8_t buf[])
+{
   //Indicates the number of bytes in the digital service list (Max = 2047 bytes, not including list size of 2 bytes)
   ensembleHeader.listSize = (uint16_t) buf[5] << 8 | buf[4];
   ensembleHeader.version = (uint16_t)buf[7] << 8 | buf[6];
@@ -1114,271 +1632,415 @@ void getEnsembleHeader(ensembleHeader_t &ensembleHeader, unsigned char serviceTy
   //ensembleHeader.reserved3 = buf[11];
 
   //Valid? Check if list exists or too big
-  if (ensembleHeader.listSize == 0 || ensembleHeader.listSize > 2694 || ensembleHeader.numServices > 32)
+  if (ensembleHeader.listSize == 0 || ensembleHeader.listSize > MAX_SERVICE_LIST_SIZE || ensembleHeader.numServices > 32)
   {
     //ensembleHeader.actualService = 0;
     //ensembleHeader.actualComponent = 0;
     ensembleHeader.listSize = 0;
     ensembleHeader.version = 0;
     ensembleHeader.numServices = 0;
-    //ensembleHeader.serviceList = nullptr;
   }
-
 }
 
-//Get ensemble an fill serviceList and componentList
+//Get ensemble an fill services and components of ensembleArena
+//Service list is read once in windows of SERVICE_LIST_WINDOW bytes and parsed across window boundaries
 void getEnsemble(ensembleHeader_t& ensembleHeader, uint8_t serviceType)
 {
-  //free memory from previous Ensemble List Data Structure
-  freeMemoryFromEnsembleList(ensembleHeader);
+  //clear previous Ensemble List Data Structure
+  clearEnsembleList(ensembleHeader);
+
+  uint8_t cmd[2];
+  cmd[0] = GET_DIGITAL_SERVICE_LIST;
+  cmd[1] = serviceType & 1;
+
+  writeCommand(cmd, sizeof(cmd));
 
-  //Read Header
-  getEnsembleHeader(ensembleHeader, serviceType);
+  //window of service list, 4 status bytes + data
+  uint8_t window[4 + SERVICE_LIST_WINDOW];
 
-  //Check services
-  if (ensembleHeader.numServices == 0 )
+  //Wait for CTS with short replies, response buffer stays intact
+  if (!readReply(window, 4))
   {
+    ensembleHeader.numServices = 0;
     Serial.print(F("No services"));
     return;
   }
 
-  //Create dynamic array of right size for serviceList
-  //ensembleHeader.serviceList = (serviceList_t*) calloc (ensembleHeader.numServices, sizeof(serviceList_t));
-  ensembleHeader.serviceList = new serviceList_t[ensembleHeader.numServices];
+  //First window with READ_REPLY, list header 8 Bytes
+  readReply(window, sizeof(window));
 
-  //No memory left
-  if (ensembleHeader.serviceList == nullptr)
+  parseEnsembleHeader(ensembleHeader, window);
+
+  //Check services
+  if (ensembleHeader.numServices == 0 )
   {
-    freeMemoryFromEnsembleList(ensembleHeader);
-    Serial.print(F("No memory left"));
+    Serial.print(F("No services"));
     return;
   }
 
-  //Read service list
-  //Read again response with readReplyOffset
-  uint8_t cmd[2];
-  cmd[0] = GET_DIGITAL_SERVICE_LIST;
-  cmd[1] = serviceType & 1;
+  //List size does not include 2 bytes of list size
+  uint16_t sizeList = ensembleHeader.listSize + 2;
 
-  writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(10000);
-  delayMicroseconds(10000);
+  //Offset of window in list, OFFSET parameter must be modulo four
+  uint16_t offsetWindow = 0;
 
-  //OFFSET parameter must be modulo four
-  //Listheader 8 Byte
-  uint16_t offset = 8;
+  //Service 24 Bytes or component 4 Bytes, collected over window boundaries
+  uint8_t record[24];
+  uint8_t lenRecord = 24;
+  uint8_t fill = 0;
+
+  //actual service and component
+  uint8_t i = 0;
+  uint8_t j = 0;
+
+  //32 bit SId without free slot, service is not stored
+  bool skip = false;
 
-  //buffer for next service 24 Bytes per service + 4 byte status
-  uint8_t service[24 + 4];
-  for (uint8_t i = 0; i < 24 + 4; i++) service[i] = 0xff;
+  //Number of components in list, only MAX_NUMBER_COMPONENTS are stored
+  uint8_t numComponents = 0;
 
-  //Cycle services
-  for (uint8_t i = 0; i < ensembleHeader.numServices && i < MAX_NUMBER_SERVICES; i++)
+  //Very memory intensive for Uno !
+  //Dont exceed MAX_NUMBER_SERVICES
+  if (ensembleHeader.numServices > MAX_NUMBER_SERVICES) ensembleHeader.numServices = MAX_NUMBER_SERVICES;
+  uint8_t numServices = ensembleHeader.numServices;
+
+  //Listheader 8 Byte
+  for (uint16_t offset = 8; offset < sizeList && i < numServices; offset++)
   {
-    readReplyOffset(service, sizeof(service), offset);
+    //Next window
+    if (offset - offsetWindow >= SERVICE_LIST_WINDOW)
+    {
+      offsetWindow += SERVICE_LIST_WINDOW;
+      readReplyOffset(window, sizeof(window), offsetWindow);
+    }
 
-    //Byte [8]
-    //Service Info 1
-    //ensembleHeader.serviceList[i].reservedServiceInfo1   = service[8] >> 7 & 1;  //RFU
-    //ensembleHeader.serviceList[i].serviceLinkingFlag    = service[8] >> 6 & 1;
-    //ensembleHeader.serviceList[i].programType           = service[8] >> 1 & 0x1F;
-    ensembleHeader.serviceList[i].dataFlag              = service[8] & 1;
+    record[fill++] = window[4 + offset - offsetWindow];
 
-    ensembleHeader.serviceList[i].serviceId = (uint32_t)service[7] << 24 | (uint32_t)service[6] << 16 | (uint32_t)service[5] << 8 | service[4];
+    //record not complete
+    if (fill < lenRecord) continue;
+    fill = 0;
 
-    /*
-        if (ensembleHeader.serviceList[i].dataFlag == 0) // Dataflag = 0 Audioprogram
+    //Service 24 Bytes
+    if (lenRecord == 24)
+    {
+      //Bytes [0:3]
+      //SIds of audio services and most data services have no ECC and fit into 16 bit
+      skip = false;
+      if (record[3] == 0 && record[2] == 0)
+      {
+        ensembleArena.serviceIds[i] = (uint16_t)record[1] << 8 | record[0];
+        ensembleArena.serviceInfo[i] = record[4] & 0x7F;
+      }
+      else if (ensembleArena.numLongServiceIds < MAX_LONG_SERVICE_IDS)
+      {
+        ensembleArena.longServiceIds[ensembleArena.numLongServiceIds] = (uint32_t)record[3] << 24 | (uint32_t)record[2] << 16 | (uint32_t)record[1] << 8 | record[0];
+        ensembleArena.serviceIds[i] = ensembleArena.numLongServiceIds++;
+        ensembleArena.serviceInfo[i] = (record[4] & 0x7F) | LONG_SERVICE_ID;
+      }
+      else
+      {
+        skip = true;
+      }
+
+      //Byte [4]
+      //Service Info 1
+      //serviceLinkingFlag    = record[4] >> 6 & 1;
+      //programType           = record[4] >> 1 & 0x1F;
+      //dataFlag              = record[4] & 1;
+
+      //Byte[5]
+      //Service Info 2
+      //localFlag             = record[5] >> 7 & 1;
+      //conditionalAccess     = record[5] >> 4 & 0x7;
+      //numComponents         = record[5] & 0x0F;
+      numComponents = record[5] & 0x0F;
+      j = 0;
+
+      //Byte [6]
+      //Service Info 3
+      //characterSet          = record[6] & 0x0F;
+
+      //Byte [7]
+      //Align Pad 1
+
+      //Dont exceed MAX_NUMBER_COMPONENTS per service and MAX_ARENA_COMPONENTS of all services
+      uint8_t stored = numComponents > MAX_NUMBER_COMPONENTS ? (uint8_t)MAX_NUMBER_COMPONENTS : numComponents;
+      if (stored > MAX_ARENA_COMPONENTS - ensembleArena.numComponents) stored = MAX_ARENA_COMPONENTS - ensembleArena.numComponents;
+
+      //Components do not fit, service is not stored
+      if (numComponents != 0 && stored == 0) skip = true;
+
+      if (!skip)
+      {
+        ensembleArena.serviceComponents[i] = (record[6] & 0x0F) << 4 | stored;
+
+        //Components follow in arena
+        ensembleArena.firstComponent[i] = ensembleArena.numComponents;
+        ensembleArena.numComponents += stored;
+
+#ifdef DAB_LABEL_POOL
+        //Byte[8:23]
+        //Service Label without trailing spaces
+        uint8_t lenLabel = 16;
+        while (lenLabel > 0 && record[8 + lenLabel - 1] == ' ') lenLabel--;
+
+        //Pool full, label is read with readServiceInformation()
+        if (ensembleArena.lenLabels + lenLabel + 1 > LABEL_POOL_SIZE)
         {
-          //Bytes [4:7]
-          ensembleHeader.serviceList[i].serviceReference = (service[5] & 0b1111) | service[4];
-          ensembleHeader.serviceList[i].countryId = (service[5] >> 4 ) & 0b1111;
+          ensembleArena.serviceLabels[i] = NO_LABEL;
         }
-
-        if (ensembleHeader.serviceList[i].dataFlag == 1) // Dataflag = 1
+        else
         {
-          //Bytes [4:7]
-          ensembleHeader.serviceList[i].serviceReference = (service[6] & 0b11) << 16 | service[5] << 8 | service[4];
-          ensembleHeader.serviceList[i].countryId = (service[6] >> 4 ) & 0b1111;
+          ensembleArena.serviceLabels[i] = ensembleArena.lenLabels;
+          memcpy(&ensembleArena.labels[ensembleArena.lenLabels], &record[8], lenLabel);
+          ensembleArena.labels[ensembleArena.lenLabels + lenLabel] = '\0';
+          ensembleArena.lenLabels += lenLabel + 1;
         }
-    */
-
-    //Byte[9]
-    //Service Info 2
-    //ensembleHeader.serviceList[i].localFlag             = service[9] >> 7 & 1;
-    //ensembleHeader.serviceList[i].conditionalAccess     = service[9] >> 4 & 0x7;
-    ensembleHeader.serviceList[i].numComponents         = service[9] & 0x0F;
-
-    //Byte [10]
-    //Service Info 3
-    // ensembleHeader.serviceList[i].reservedServiceInfo3 = service[10] >> 4 & 0x0F;
-    //ensembleHeader.serviceList[i].characterSet          = service[10] & 0x0F;
-
-    //Byte [11]
-    //Align Pad 1
-
-    //Byte[12:28]
-    //Service Label
-    //memcpy(ensembleHeader.serviceList[i].serviceLabel, &service[12], 16);
-    //Terminate string
-    //ensembleHeader.serviceList[i].serviceLabel[16] = '\0';
-
-    //Create dynamic array of right size for componentList
-    //ensembleHeader.serviceList[i].componentList = (componentList_t*) realloc(ensembleHeader.serviceList[i].componentList, ensembleHeader.serviceList[i].numComponents * sizeof(componentList_t));
-    ensembleHeader.serviceList[i].componentList = new componentList_t[ensembleHeader.serviceList[i].numComponents];
-
-    //No memory left
-    if (ensembleHeader.serviceList[i].componentList == nullptr)
+#endif
+      }
+
+      //No components, next service
+      if (numComponents == 0)
+      {
+        if (!skip) i++;
+        continue;
+      }
+
+      //Components 4 Bytes
+      lenRecord = 4;
+    }
+    //Component 4 Bytes
+    else
     {
-      //free memory
-      //free(ensembleHeader.serviceList[i].componentList);
-      delete[] ensembleHeader.serviceList[i].componentList;
-      //Set pointer to nullptr
-      ensembleHeader.serviceList[i].componentList = nullptr;
-      Serial.print(F("No memory left"));
-      return;
+      //Only stored components
+      if (!skip && j < getNumComponents(i))
+      {
+        uint8_t component = ensembleArena.firstComponent[i] + j;
+        ensembleArena.componentIds[component] = (uint16_t)record[1] << 8 | record[0];
+        //conditionalAccessFlag = record[2] & 1;
+        //secondaryFlag = record[2] >> 1 & 1;
+        //serviceType = record[2] >> 2 & 0x3F;
+        ensembleArena.componentInfo[component] = record[2];
+        //validFlag   = record[3] & 1;
+      }
+
+      //Last component, next service
+      if (++j == numComponents)
+      {
+        if (!skip) i++;
+        lenRecord = 24;
+      }
     }
+  }//list cycle
 
-    //Components
-    //Very memory intensive for Uno !
-    //Dont exceed MAX_NUMBER_COMPONENTS
+  //Only complete services
+  ensembleHeader.numServices = i;
 
-    //intial offset component
-    uint16_t offsetComponent = offset + 24;//header 8 + service 24
+  //Sorted index for search and next/previous
+  buildServiceIndex(ensembleHeader);
 
-    for (uint8_t j = 0; (j < ensembleHeader.serviceList[i].numComponents) && (j < MAX_NUMBER_COMPONENTS); j++)
-    {
-      //Buffer status 4 + component 4
-      uint8_t component[4 + 4] = {0xff, 0xff, 0xff, 0xff, 0, 0, 0, 0};
-
-      //24 bytes for one service + n Components * 4 Bytes
-      offsetComponent = offsetComponent + j * (ensembleHeader.serviceList[i].numComponents * 4); //4 bytes per component
-
-      readReplyOffset(component, sizeof(component), offsetComponent);
-
-      //4 bytes per component
-      ensembleHeader.serviceList[i].componentList[j].componentId = (uint16_t)component[5] << 8 | component[4];
-      ensembleHeader.serviceList[i].componentList[j].conditionalAccessFlag = component[6] & 1;
-      ensembleHeader.serviceList[i].componentList[j].secondaryFlag = component[6] >> 1 & 1;
-      ensembleHeader.serviceList[i].componentList[j].serviceType = component[6] >> 2 & 0x7F;
-      ensembleHeader.serviceList[i].componentList[j].validFlag   = component[7] & 1;
-
-      /*
-        //Debugging
-            Serial.print(F("Service: "));
-            Serial.print(i);
-            Serial.print(F("\tId:\t"));
-            Serial.print(ensembleHeader.serviceList[i].serviceId, HEX);
-            Serial.print(F("\tOffset:\t"));
-            Serial.println(offset);
-            Serial.print(F("Num Components:\t"));
-            Serial.println(ensembleHeader.serviceList[i].numComponents);
-
-            Serial.print(F("Component:\t"));
-            Serial.print(j);
-            Serial.print(F("\tId:\t"));
-            Serial.print(ensembleHeader.serviceList[i].componentList[j].componentId, HEX);
-            Serial.print(F("\toffset:\t"));
-            Serial.println(offsetComponent);
-            //Serial.println(ensembleHeader.serviceList[i].serviceLabel);
-
-            Serial.print(F("Free RAM: "));
-            Serial.println(freeRam());
-            Serial.println();
-      */
-
-    }//component cycle
-    //New offset
-    //24 bytes for one service + n Components * 4 Bytes
-    offset = offset + (24 + ensembleHeader.serviceList[i].numComponents * 4); //4 bytes per component
-  }//service cycle
-
-}
-
-//Free memory from ensembleList data structures
-void freeMemoryFromEnsembleList(ensembleHeader_t &ensembleHeader)
-{
-  //ensemble empty
-  if (ensembleHeader.numServices == 0 || ensembleHeader.serviceList == nullptr)
-  {
-    Serial.println(F("numServices = 0"));
-    return;
+  //High water mark of arena
+  if (i > ensembleArena.maxServices) ensembleArena.maxServices = i;
+  if (ensembleArena.numComponents > ensembleArena.maxComponents) ensembleArena.maxComponents = ensembleArena.numComponents;
+}
+
+//Parse ensemble only if ensemble id or service list version changed, true if services are available
+bool updateEnsemble(ensembleHeader_t& ensembleHeader, unsigned char serviceType)
+{
+  eventInformation_t eventInformation;
+  readEventInformation(eventInformation);
+
+  //no service list yet, cache only valid without tuning or from snapshot
+  if (eventInformation.serviceListAvailable == 0)
+  {
+    return ensembleCache.valid && (!ensembleCache.checkEnsemble || ensembleCache.snapshot) && ensembleHeader.numServices != 0;
   }
-  else
+
+  //snapshot is checked now
+  ensembleCache.snapshot = 0;
+
+  //same list version without reconfiguration
+  bool hit = ensembleCache.valid
+             && ensembleHeader.numServices != 0
+             && ensembleCache.serviceType == serviceType
+             && ensembleCache.version == eventInformation.currentServiceListVersion
+             && eventInformation.ensembleReconfigInterrupt == 0;
+
+  ensembleInformation_t ensembleInformation;
+
+  //after tuning the same version can belong to another ensemble
+  if (ensembleCache.checkEnsemble)
+  {
+    readEnsembleInformation(ensembleInformation);
+    hit = hit && ensembleCache.ensembleId == ensembleInformation.ensembleId;
+  }
+
+  if (hit)
   {
-    Serial.print(F("numServices = "));
-    Serial.println(ensembleHeader.numServices);
+    ensembleCache.checkEnsemble = 0;
+    ensembleCache.hits++;
+    return true;
   }
 
-  //cycle numServices
+  //parse service list
+  ensembleCache.misses++;
+
+  //Acknowledge before list is read, otherwise a sticky interrupt misses every later call. Reconfiguration during read interrupts again
+  if (eventInformation.ensembleReconfigInterrupt || eventInformation.serviceListInterrupt) readEventInformation(eventInformation, 1);
+
+  getEnsemble(ensembleHeader, serviceType);
+
+  if (ensembleHeader.numServices == 0) return false;
+
+  if (!ensembleCache.checkEnsemble) readEnsembleInformation(ensembleInformation);
+
+  ensembleCache.ensembleId    = ensembleInformation.ensembleId;
+  ensembleCache.version       = eventInformation.currentServiceListVersion;
+  ensembleCache.serviceType   = serviceType;
+  ensembleCache.valid         = 1;
+  ensembleCache.checkEnsemble = 0;
+
+  //Remember services for other ensembles
+  storeEnsembleInDirectory(ensembleHeader, ensembleCache.index, ensembleCache.ensembleId);
+
+  //Restore at next boot, only the playing ensemble and not the indices of a directory fill
+  if (scanJob.state != SCAN_DIRECTORY_LIST) saveEnsembleSnapshot();
+
+  return true;
+}
+
+//Service id with ECC from longServiceIds
+unsigned long getServiceId(unsigned char service)
+{
+  if (ensembleArena.serviceInfo[service] & LONG_SERVICE_ID) return ensembleArena.longServiceIds[ensembleArena.serviceIds[service]];
+
+  return ensembleArena.serviceIds[service];
+}
+
+//0 = audio, 1 = data service
+unsigned char getDataFlag(unsigned char service)
+{
+  return ensembleArena.serviceInfo[service] & 1;
+}
+
+//PTY
+unsigned char getProgramType(unsigned char service)
+{
+  return ensembleArena.serviceInfo[service] >> 1 & 0x1F;
+}
+
+unsigned char getCharacterSet(unsigned char service)
+{
+  return ensembleArena.serviceComponents[service] >> 4;
+}
+
+//Stored components, max MAX_NUMBER_COMPONENTS
+unsigned char getNumComponents(unsigned char service)
+{
+  return ensembleArena.serviceComponents[service] & 0x0F;
+}
+
+unsigned short getComponentId(unsigned char service, unsigned char component)
+{
+  return ensembleArena.componentIds[ensembleArena.firstComponent[service] + component];
+}
+
+//Audio Service Component Type
+unsigned char getComponentType(unsigned char service, unsigned char component)
+{
+  return ensembleArena.componentInfo[ensembleArena.firstComponent[service] + component] >> 2;
+}
+
+//Service label from ensemble, nullptr if not in pool or built without DAB_LABEL_POOL
+const char* getServiceLabel(unsigned char service)
+{
+#ifdef DAB_LABEL_POOL
+  if (ensembleArena.serviceLabels[service] == NO_LABEL) return nullptr;
+
+  return &ensembleArena.labels[ensembleArena.serviceLabels[service]];
+#else
+  (void)service;
+  return nullptr;
+#endif
+}
+
+//Clear ensembleList data structures, arena is reused without heap
+void clearEnsembleList(ensembleHeader_t &ensembleHeader)
+{
+  ensembleCache.valid = 0;
+  ensembleHeader.numServices = 0;
+  ensembleArena.numComponents = 0;
+  ensembleArena.numLongServiceIds = 0;
+#ifdef DAB_LABEL_POOL
+  ensembleArena.lenLabels = 0;
+#endif
+}
+
+//Sort services of arena by serviceId, stable order for next/previous
+void buildServiceIndex(ensembleHeader_t &ensembleHeader)
+{
+  //insertion sort, list is parsed once
   for (uint8_t i = 0; i < ensembleHeader.numServices; i++)
   {
-    //pointer to componentList is available
-    if (ensembleHeader.serviceList[i].componentList != nullptr)
+    uint8_t j = i;
+    while (j > 0 && getServiceId(ensembleArena.order[j - 1]) > getServiceId(i))
     {
-      delete[] ensembleHeader.serviceList[i].componentList;
-      //Serial.print(F("Delete componentList of service:\t"));
-      //Serial.println(i);
+      ensembleArena.order[j] = ensembleArena.order[j - 1];
+      j--;
     }
-    //componentList deleted
-    //Set pointer to component list to nullptr
-    ensembleHeader.serviceList[i].componentList = nullptr;
+    ensembleArena.order[j] = i;
   }
-  //pointer to serviceList is available
-  if (ensembleHeader.serviceList != nullptr)
+  ensembleArena.actualRank = 0;
+}
+
+//Binary search of serviceId in sorted index, rank is position in index
+bool findService(ensembleHeader_t &ensembleHeader, unsigned long serviceId, unsigned char &rank)
+{
+  uint8_t low = 0;
+  uint8_t high = ensembleHeader.numServices;
+
+  while (low < high)
   {
-    //Serial.print(F("Delete serviceList\t"));
-    delete[] ensembleHeader.serviceList;
+    uint8_t middle = (low + high) / 2;
+    if (getServiceId(ensembleArena.order[middle]) < serviceId) low = middle + 1;
+    else high = middle;
   }
-  //Set pointer to service list to nullptr
-  ensembleHeader.serviceList = nullptr;
 
-  //Serial.println(F("serviceList deleted"));
-  //Serial.println();
+  rank = low;
+  return low < ensembleHeader.numServices && getServiceId(ensembleArena.order[low]) == serviceId;
 }
 
 //Search service and component in servicelist
 bool searchService(unsigned long &serviceId, unsigned long &componentId)
 {
-  bool found = false;
-
   //no services
   if (ensembleHeader.numServices == 0)
   {
     //parse ensemble
-    getEnsemble(ensembleHeader);
     //nothing found return
-    if (ensembleHeader.numServices == 0)  return false;
+    if (!updateEnsemble(ensembleHeader)) return false;
   }
 
-  //search all services in servicelist
-  for (uint8_t i = 0; i < ensembleHeader.listSize; i++)
-  {
-    //found ?
-    if (ensembleHeader.serviceList[i].serviceId == serviceId)
-    {
-      //remember
-      ensembleHeader.actualService = i;
+  //search service in sorted index
+  unsigned char rank;
+  if (!findService(ensembleHeader, serviceId, rank)) return false;
+
+  //remember
+  ensembleArena.actualRank = rank;
+  ensembleHeader.actualService = ensembleArena.order[rank];
 
 #ifdef DEBUG_PARSE_ENSEMBLE
-      Serial.println(i);
-      Serial.println(serviceId, HEX);
-      Serial.println(ensembleHeader.actualService);
-      Serial.println();
+  Serial.println(rank);
+  Serial.println(serviceId, HEX);
+  Serial.println(ensembleHeader.actualService);
+  Serial.println();
 #endif //DEBUG_PARSE_ENSEMBLE
 
-      found = true;
-      break;
-    }
-  }
-
-  //not found stop and return
-  if (found == false) return found;
-
-  //search all components in componentList
-  for (uint8_t j = 0; j < ensembleHeader.serviceList[ensembleHeader.actualService].numComponents; j++)
+  //search all components of service, max MAX_NUMBER_COMPONENTS
+  for (uint8_t j = 0; j < getNumComponents(ensembleHeader.actualService); j++)
   {
     //found ?
-    if (ensembleHeader.serviceList[ensembleHeader.actualService].componentList[j].componentId == componentId)
+    if (getComponentId(ensembleHeader.actualService, j) == componentId)
     {
       //remember
       ensembleHeader.actualComponent = j;
@@ -1388,28 +2050,22 @@ bool searchService(unsigned long &serviceId, unsigned long &componentId)
       Serial.println(ensembleHeader.actualComponent);
       Serial.println();
 #endif //DEBUG_PARSE_ENSEMBLE
-      found = true;
-      break;
+      return true;
     }
   }
 
-  return found;
+  return false;
 }
 
 //Start next service in ensemble
 void nextService(unsigned long &serviceId, unsigned long &componentId)
 {
-  //no ensemble
-  if (ensembleHeader.numServices == 0)
+  //parse ensemble if service list changed
+  if (!updateEnsemble(ensembleHeader))
   {
-    //parse ensemble
-    getEnsemble(ensembleHeader);
     //no reception, no service list ready return
-    if (ensembleHeader.numServices == 0)
-    {
-      Serial.println(F("No service"));
-      return;
-    }
+    Serial.println(F("No service"));
+    return;
   }
 
   //lookup in ensemble because of changed frequency
@@ -1418,14 +2074,20 @@ void nextService(unsigned long &serviceId, unsigned long &componentId)
   //Found in ensemble
   if (found)
   {
-    //Wrap around
-    if (ensembleHeader.actualService == ensembleHeader.numServices - 1)
-      ensembleHeader.actualService = 0;
-    else  ensembleHeader.actualService++;
+    //Wrap around in order of serviceId, skip services without components, actual service has one
+    for (uint8_t step = 0; step < ensembleHeader.numServices; step++)
+    {
+      if (ensembleArena.actualRank == ensembleHeader.numServices - 1)
+        ensembleArena.actualRank = 0;
+      else  ensembleArena.actualRank++;
+      if (getNumComponents(ensembleArena.order[ensembleArena.actualRank]) != 0) break;
+    }
+
+    ensembleHeader.actualService = ensembleArena.order[ensembleArena.actualRank];
 
     //global var
-    componentId = ensembleHeader.serviceList[ensembleHeader.actualService].componentList[0].componentId;
-    serviceId = ensembleHeader.serviceList[ensembleHeader.actualService].serviceId;
+    componentId = getComponentId(ensembleHeader.actualService, 0);
+    serviceId = getServiceId(ensembleHeader.actualService);
 
     startService(serviceId, componentId);
   }
@@ -1434,17 +2096,12 @@ void nextService(unsigned long &serviceId, unsigned long &componentId)
 //Start previous service in ensemble
 void previousService(unsigned long &serviceId, unsigned long &componentId)
 {
-  //no ensemble
-  if (ensembleHeader.numServices == 0)
+  //parse ensemble if service list changed
+  if (!updateEnsemble(ensembleHeader))
   {
-    //parse ensemble
-    getEnsemble(ensembleHeader);
     //no reception, no service list ready return
-    if (ensembleHeader.numServices == 0)
-    {
-      Serial.println(F("No service"));
-      return;
-    }
+    Serial.println(F("No service"));
+    return;
   }
 
   //lookup in ensemble because of changed frequency
@@ -1453,52 +2110,32 @@ void previousService(unsigned long &serviceId, unsigned long &componentId)
   //Found in ensemble
   if (found)
   {
-    //Wrap around
-    if (ensembleHeader.actualService == 0)
-      ensembleHeader.actualService = ensembleHeader.numServices;
-    else ensembleHeader.actualService--;
+    //Wrap around in order of serviceId, skip services without components, actual service has one
+    for (uint8_t step = 0; step < ensembleHeader.numServices; step++)
+    {
+      if (ensembleArena.actualRank == 0)
+        ensembleArena.actualRank = ensembleHeader.numServices - 1;
+      else ensembleArena.actualRank--;
+      if (getNumComponents(ensembleArena.order[ensembleArena.actualRank]) != 0) break;
+    }
+
+    ensembleHeader.actualService = ensembleArena.order[ensembleArena.actualRank];
 
     //global var
-    componentId = ensembleHeader.serviceList[ensembleHeader.actualService].componentList[0].componentId;
-    serviceId = ensembleHeader.serviceList[ensembleHeader.actualService].serviceId;
+    componentId = getComponentId(ensembleHeader.actualService, 0);
+    serviceId = getServiceId(ensembleHeader.actualService);
 
     startService(serviceId, componentId);
   }
 }
 
-//Start first service (0 = audio) in ensemble
+//Start first service (0 = audio) in ensemble, service list has to be available
+//waiting for service list is done by beginFirstService() in scanJob
 void startFirstService(unsigned long &serviceId, unsigned long &componentId, uint8_t serviceType)
 {
-  eventInformation_t eventInformation;
-
-  //wait for serviceList
-  for (unsigned char retry = 0; retry < MAX_RETRY; retry++)
-  {
-    //longer delay
-    for (unsigned char i = 0; i < MAX_RETRY; i++)
-    {
-      delayMicroseconds(DURATION_10000_MIKRO);
-      delayMicroseconds(DURATION_10000_MIKRO);
-      delayMicroseconds(DURATION_10000_MIKRO);
-    }
-
-    readEventInformation(eventInformation);
-
-    if (eventInformation.serviceListAvailable == 1)
-    {
-      break;
-    }
-    //too many tries
-    if (retry == MAX_RETRY - 1)
-    {
-      Serial.println(F("Error ServList"));
-      return;
-    }
-  }
-
   //Parse servicelist
   /*
-    if (ensembleHeader.numServices == 0 || ensembleHeader.serviceList == nullptr)
+    if (ensembleHeader.numServices == 0)
     {
     Serial.println(F("Parse ServList"));
     //parse ensemble
@@ -1506,27 +2143,26 @@ void startFirstService(unsigned long &serviceId, unsigned long &componentId, uin
     //nothing found return
     if (ensembleHeader.numServices == 0)  return;
     }
-  */  Serial.println(F("Parse ServList"));
-  //parse ensemble every time
-
-  getEnsemble(ensembleHeader);
+  */
+  //parse ensemble if service list changed
+  updateEnsemble(ensembleHeader);
 
-  //there is an ensemble with serviceList and numServices
-  if (ensembleHeader.numServices != 0 && ensembleHeader.serviceList != nullptr)
+  //there is an ensemble with services
+  if (ensembleHeader.numServices != 0)
   {
     //cycle trough numServices
     for (uint8_t i = 0; i < ensembleHeader.numServices; i++)
     {
-      //Serial.println(ensembleHeader.serviceList[i].serviceId, HEX);
-      //Serial.println(ensembleHeader.serviceList[i].componentList[i].componentId, HEX);
-      //Serial.println(ensembleHeader.serviceList[i].dataFlag);
+      //Serial.println(getServiceId(i), HEX);
+      //Serial.println(getComponentId(i, 0), HEX);
+      //Serial.println(getDataFlag(i));
 
-      //check if an audio service, serviceType = 0
-      if (ensembleHeader.serviceList[i].dataFlag == serviceType)
+      //check if an audio service, serviceType = 0, with component to start
+      if (getDataFlag(i) == serviceType && getNumComponents(i) != 0)
       {
         //set members
-        serviceId = ensembleHeader.serviceList[i].serviceId;
-        componentId = ensembleHeader.serviceList[i].componentList[0].componentId;
+        serviceId = getServiceId(i);
+        componentId = getComponentId(i, 0);
         //start
         startService(serviceId, componentId);
         break;
@@ -1553,11 +2189,35 @@ void tuneIndex(unsigned char index, unsigned short varCap, unsigned char injecti
     0 : Automatically determines the cap setting
   */
 
+  //STCINT of pending tune of cancelled scan would complete this tune
+  if (scanJob.tuning)
+  {
+    rsqInformation_t rsqInformation;
+    waitSeekTuneComplete(TIMEOUT_TUNE);
+    clearSeekTuneComplete(rsqInformation);
+    scanJob.tuning = 0;
+    scanJob.cancelled = 0;
+  }
+
+  unsigned long start = millis();
+
+  writeTuneIndex(index, varCap, injection);
+
+  //Only STCIEN is set in INT_CTL_ENABLE, tune is done as soon as STCINT is set
+  tuneStatistics.complete = waitSeekTuneComplete(TIMEOUT_TUNE);
+  tuneStatistics.latency = millis() - start;
+  tuneStatistics.index = index;
+
+  rsqInformation_t rsqInformation;
+  clearSeekTuneComplete(rsqInformation);
+}
+
+//0xB0 Sends tune to frequency index without waiting for seek tune complete
+void writeTuneIndex(unsigned char index, unsigned short varCap, unsigned char injection)
+{
   //Validity index 0...47
   if (index >= MAX_INDEX) index = MAX_INDEX - 1;
 
-  unsigned char buf[4] = {0xff, 0xff, 0xff, 0xff};
-
   unsigned char cmd[6];
   cmd[0] = DAB_TUNE_FREQ;
   cmd[1] = injection & 3;
@@ -1566,25 +2226,66 @@ void tuneIndex(unsigned char index, unsigned short varCap, unsigned char injecti
   cmd[4] = varCap & 0xFF;
   cmd[5] = varCap >> 8;
 
+  unsigned char buf[4] = {0xff, 0xff, 0xff, 0xff};
+
   writeCommand(cmd, sizeof(cmd));
+  readReply(buf, sizeof(buf));
+
+  //CTS would hold INTB asserted until next command, so INTB signals only STCINT while tuning
+  //STCINT set meanwhile asserts INTB as soon as STCIEN is set
+  writePropertyValue(INT_CTL_ENABLE, INT_SOURCES_TUNE);
+
+  //other frequency, ensemble of cache has to be checked
+  ensembleCache.checkEnsemble = 1;
+  ensembleCache.index = index;
+}
+
+//Waits for STCINT on INTB or polls status, false after timeout in ms
+bool waitSeekTuneComplete(unsigned short timeout)
+{
+  unsigned char buf[4] = {0xff, 0xff, 0xff, 0xff};
 
-  //STC ? 600ms = 60 * 10000us
-  for (uint8_t i = 0; i < 10; i++)
+  unsigned long start = millis();
+  unsigned long lastPoll = micros();
+
+  //INTB signals only STCINT while tuning, an edge reads status at once
+  bool lastInterrupt = false;
+
+  tuneStatistics.interrupt = 0;
+
+  //Pin 6 is no external interrupt pin of UNO, so INTB is polled in short steps
+  while (millis() - start < timeout)
   {
-    //wait 30*DURATION_TUNE
-    for (uint8_t j = 0; j < 30; j++)
-      delayMicroseconds(DURATION_TUNE);
+    bool interrupt = readInterrupt();
+    bool edge = interrupt && !lastInterrupt;
+    lastInterrupt = interrupt;
 
-    readReply(buf, sizeof(buf));
-    Serial.print('.');
-    if ((buf[0] & 1) == 1)
+    if (edge || micros() - lastPoll >= DURATION_STC_POLL)
     {
-      for (uint8_t j = 0; j < 30; j++)
-        delayMicroseconds(DURATION_TUNE);
-      break;
+      lastPoll = micros();
+      readReply(buf, sizeof(buf));
+
+      //STCINT
+      if ((buf[0] & 1) == 1)
+      {
+        tuneStatistics.interrupt = edge;
+        return true;
+      }
     }
+
+    delayMicroseconds(DURATION_POLL_INTERRUPT);
   }
-  Serial.println();
+  return false;
+}
+
+//Enables CTS on INTB again and clears STCINT of tune
+void clearSeekTuneComplete(rsqInformation_t& rsqInformation)
+{
+  //STCIEN is cleared first, so CTS of DAB_DIGRAD_STATUS is an edge for readReply()
+  writePropertyValue(INT_CTL_ENABLE, INT_SOURCES_REPLY);
+
+  //Clear STCINT
+  readRsqInformation(rsqInformation, 0, 0, 1);
 }
 
 //0xB2 DAB_DIGRAD_STATUS Get status information about the received signal quality
@@ -1598,10 +2299,8 @@ void readRsqInformation(rsqInformation_t& rsqInformation, unsigned char clearDig
   //initalize buffer
   for (unsigned char i = 0; i < 23; i++) buf[i] = 0xff;
 
+  //readReply() waits for CTS
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(DURATION_10000_MIKRO);
-  delayMicroseconds(DURATION_10000_MIKRO);
-  delayMicroseconds(DURATION_10000_MIKRO);
   readReply(buf, sizeof(buf));
 
   rsqInformation.hardMuteInterrupt =  buf[4] >> 4 & 1;
@@ -1638,8 +2337,8 @@ void readEventInformation(eventInformation_t& eventInformation, unsigned char ev
 
   unsigned char buf[8] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
 
+  //readReply() waits for CTS
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(DURATION_10000_MIKRO);
   readReply(buf, sizeof(buf));
 
   eventInformation.ensembleReconfigInterrupt        = buf[4] >> 7 & 1;
@@ -1668,9 +2367,8 @@ void readEnsembleInformation(ensembleInformation_t& ensembleInformation)
   unsigned char buf[26];
   for (unsigned short i = 0; i < 26; i++) buf[i] = 0xff;
 
+  //readReply() waits for CTS
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(DURATION_10000_MIKRO);
-  delayMicroseconds(DURATION_10000_MIKRO);
   readReply(buf, sizeof(buf));
 
   ensembleInformation.ensembleId        = (unsigned short)buf[5] << 8 | buf[4];
@@ -1701,7 +2399,6 @@ void readServiceLinkingInfo(serviceLinkingInformation_t& serviceLinkingInformati
   for (unsigned short i = 0; i < bufferSize; i++) buf[i] = 0xff;
 
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(DURATION_10000_MIKRO);
   readReply(buf, sizeof(buf));
 
   serviceLinkingInformation.size                = (unsigned short) buf[5] << 8 | buf[4];
@@ -1743,74 +2440,59 @@ void writeFrequencyTable(const unsigned long frequencyTable[], const unsigned ch
   uint8_t buf[4] = {0xff, 0xff, 0xff, 0xff};
 
   writeCommandArgument(cmd, sizeof(cmd), arg, sizeof(arg));
-  delayMicroseconds(DURATION_10000_MIKRO);
   readReply(buf, sizeof(buf));
+
+  //cache is read again at next readFrequencyTable()
+  frequencyTableHeader.valid = 0;
 }
 
-//0xB9 DAB_GET_FREQ_LIST Get frequency table
+//0xB9 DAB_GET_FREQ_LIST Get number of frequencies, only if cache is not valid
 void readFrequencyTable(frequencyTableHeader_t& frequencyTableHeader)
 {
-  //free memory from previous table
-  if (frequencyTableHeader.table != nullptr)
-  {
-    delete[]frequencyTableHeader.table;
-    frequencyTableHeader.table = nullptr;
-    frequencyTableHeader.number = 0;
-  }
+  //table of device did not change
+  if (frequencyTableHeader.valid) return;
+
+  frequencyTableHeader.number = 0;
 
   uint8_t cmd[2]  = {DAB_GET_FREQ_LIST, 0};
-  //4 Statusbytes + 4 Bytes from command DAB_GET_FREQ_LIST
+  //4 Statusbytes, NUM_FREQS and 3 reserved bytes
   uint8_t buf[8] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
 
-  //read number of frequencies
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(DURATION_10000_MIKRO);
-  readReply(buf, sizeof(buf));
+  if (!readReply(buf, sizeof(buf))) return;
 
-  //save number of frequencies in table
-  frequencyTableHeader.number = buf[4];
+  uint8_t number = buf[4];
 
   //Validity ?
-  if (frequencyTableHeader.number > MAX_INDEX)
-  {
-    frequencyTableHeader.number = 0;
-  }
+  if (number > MAX_INDEX) return;
 
-  //numberFrequencies ok !
-  else
-  {
-    //Dynamically allocate memory
-    frequencyTableHeader.table = new uint32_t[frequencyTableHeader.number];
+  frequencyTableHeader.number = number;
+  frequencyTableHeader.valid = 1;
+}
 
-    //Error
-    if (frequencyTableHeader.table == nullptr)
-    {
-      frequencyTableHeader.number = 0;
-    }
-    //Dynamically allocate memory ok !
-    else
-    {
-      writeCommand(cmd, sizeof(cmd));
-      delayMicroseconds(DURATION_10000_MIKRO);
+//0xB9 DAB_GET_FREQ_LIST Get len frequencies from index first on, max FREQ_TABLE_CHUNK, false if not in table
+bool readFrequencies(uint32_t frequencies[], uint8_t first, uint8_t len)
+{
+  uint8_t cmd[2]  = {DAB_GET_FREQ_LIST, 0};
+  //4 Statusbytes + 4 Bytes per frequency, first chunk starts with NUM_FREQS and 3 reserved bytes
+  uint8_t buf[4 + 4 * FREQ_TABLE_CHUNK];
+  for (uint8_t j = 0; j < sizeof(buf); j++) buf[j] = 0xff;
 
-      //Fill index table
-      //Start reading 4 Bytes per frequency
-      //OFFSET parameter must be modulo four
-      uint16_t offset = 0;
-      //readReplyOffset(buf, sizeof(buf), offset);
+  if (len > FREQ_TABLE_CHUNK) len = FREQ_TABLE_CHUNK;
 
-      for (uint8_t i = 0; i < frequencyTableHeader.number; i++)
-      {
-        offset = offset + 4 ; //increase offset to next frequency
-        readReplyOffset(buf, sizeof(buf), offset);
+  //read number of frequencies, response buffer stays intact for READ_OFFSET
+  writeCommand(cmd, sizeof(cmd));
+  if (!readReply(buf, 8)) return false;
+  if (first + len > buf[4]) return false;
 
-        frequencyTableHeader.table[i] = (uint32_t) buf[7] << 24 | (uint32_t) buf[6] << 16 | (uint32_t) buf[5] << 8 | buf[4];
+  //OFFSET parameter must be modulo four
+  if (!readReplyOffset(buf, 4 + 4 * len, 4 + 4 * first)) return false;
 
-        //initalize for next frequency
-        for (uint8_t j = 0;  j < 8; j++) buf[j] = 0xff;
-      }//for
-    }//else
-  }//else
+  for (uint8_t j = 0; j < len; j++)
+  {
+    frequencies[j] = (uint32_t) buf[7 + 4 * j] << 24 | (uint32_t) buf[6 + 4 * j] << 16 | (uint32_t) buf[5 + 4 * j] << 8 | buf[4 + 4 * j];
+  }
+  return true;
 }
 
 //0xBB DAB_GET_COMPONENT_INFO Get information about the component application data
@@ -1851,8 +2533,6 @@ void readComponentInformation(componentInformation_t &componentInformation, unsi
   cmd[11] = componentId >> 24 & 0xFF;
 
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(10000);
-  delayMicroseconds(10000);
   readReply(buf, sizeof(buf));
 
   componentInformation.globalId            = buf[4];
@@ -1930,7 +2610,6 @@ void readDateTime(timeDab_t& timeDab, unsigned char timeType)
   for (unsigned short i = 0; i < 11; i++) buf[i] = 0xff;
 
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(10000);
   readReply(buf, sizeof(buf));
 
   timeDab.year    = (unsigned short)buf[5] << 8 | buf[4];
@@ -1954,8 +2633,6 @@ void readAudioInformation(audioInformation_t& audioInformation)
   for (unsigned char i = 0; i < 10; i++) buf[i] = 0xff;
 
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(10000);
-  delayMicroseconds(10000);
   readReply(buf, sizeof(buf));
 
   audioInformation.audioBitRate =     (unsigned short) buf[5] << 8 | buf[4];
@@ -1989,8 +2666,7 @@ void readComponentTechnicalInformation(componentTechnicalInformation_t& componen
   for (unsigned short i = 0; i < 12; i++) buf[i] = 0xff;
 
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(10000);
-  delayMicroseconds(10000);
+  //readReply() waits for CTS
   readReply(buf, sizeof(buf));
 
   componentTechnicalInformation.serviceMode    = buf[4];
@@ -2011,7 +2687,6 @@ void readFrequencyInformationTable(frequencyInformationTableHeader_t& frequencyI
   for (unsigned short i = 0; i < 20; i++) buf[i] = 0xff;
 
   writeCommand(cmd, sizeof(cmd));
-  delayMicroseconds(10000);
   readReply(buf, sizeof(buf));
 
   serialPrintSi468x::printResponseHex(buf, sizeof(buf));
@@ -2053,8 +2728,6 @@ void readServiceInformation(serviceInformation_t& serviceInformation, unsigned l
   arg[6] = serviceId >> 24 & 0xFF;
 
   writeCommandArgument(cmd, sizeof(cmd), arg, sizeof(arg));
-  delayMicroseconds(DURATION_10000_MIKRO);
-  delayMicroseconds(DURATION_10000_MIKRO);
   readReply(buf, sizeof(buf));
 
   //serviceInfo1
@@ -2079,59 +2752,507 @@ void readServiceInformation(serviceInformation_t& serviceInformation, unsigned l
 }
 
 
+//Scan all indices of frequency table, fast detect first, then full acquisition on candidates, blocks until done
 void scanIndices(indexListHeader_t& indexListHeader)
 {
-  //free memory from previous table
-  delete[]indexListHeader.indexList;
-  indexListHeader.indexList = nullptr;
-  indexListHeader.size = 0;
+  beginScan(indexListHeader);
+  while (pollScan());
+}
 
+//Start band scan in scanJob, valid indices are appended to indexListHeader while scanning
+void beginScan(indexListHeader_t& indexListHeader, scanProgress_t progress, bool startService)
+{
+  cancelScan();
+
+  //clear previous table, table on heap for MAX_VALID_INDICES once per scan, trimmed when scan ends
+#ifndef DAB_FIXED_INDEX_LIST
+  free(indexListHeader.indexList);
+  indexListHeader.indexList = (indexList_t*) malloc(MAX_VALID_INDICES * sizeof(indexList_t));
+  indexListHeader.capacity = indexListHeader.indexList != nullptr ? (uint8_t)MAX_VALID_INDICES : 0;
+#endif
+  indexListHeader.size = 0;
 
   //get actual number of indices to scan from frequencyList
   readFrequencyTable(frequencyTableHeader);
-  uint8_t numberIndices = frequencyTableHeader.number;
-  //number of valid indices found
-  uint8_t numberIndicesValid = 0;
 
-  Serial.print(F("numberIndices: "));
-  Serial.println(numberIndices);
+  scanJob.numberIndices = frequencyTableHeader.number;
+  scanJob.index = 0;
+  scanJob.found = 0;
+  scanJob.startService = startService;
+  scanJob.serviceType = 0;
+  scanJob.directory = 0;
+  scanJob.indexListHeader = &indexListHeader;
+  scanJob.progress = progress;
+
+  //Candidates of fast detect phase, one bit per index
+  for (uint8_t i = 0; i < sizeof(scanJob.candidates); i++) scanJob.candidates[i] = 0;
+
+  scanStatistics.indices = scanJob.numberIndices;
+  scanStatistics.candidates = 0;
+  scanStatistics.valid = 0;
+  scanStatistics.durationFast = 0;
+  scanStatistics.durationFull = 0;
+
+  if (scanJob.numberIndices == 0) return;
+
+  //Phase 1: short acquisition, only fast detect confidence is used
+  scanJob.acqTime = readPropertyValueShadow(DAB_VALID_ACQ_TIME);
+  scanJob.syncTime = readPropertyValueShadow(DAB_VALID_SYNC_TIME);
+  writePropertyValue(DAB_VALID_ACQ_TIME, FAST_SCAN_ACQ_TIME);
+  writePropertyValue(DAB_VALID_SYNC_TIME, FAST_SCAN_SYNC_TIME);
+
+  scanJob.start = millis();
+  scanJob.state = SCAN_FAST;
+}
 
-  //Scan trough indices - start with index 0
-  for (unsigned char i = 0;  i < numberIndices; i++)
-  {
-    tuneIndex(i);
+//Start seek up/down to next valid index in scanJob
+void beginSeek(bool up, scanProgress_t progress)
+{
+  cancelScan();
 
-    rsqInformation_t rsqInformation;
-    //Check receive signal quality
-    readRsqInformation(rsqInformation);
+  //get actual number of indices
+  readFrequencyTable(frequencyTableHeader);
+  scanJob.numberIndices = frequencyTableHeader.number;
+  if (scanJob.numberIndices == 0) return;
 
-    //DAB found and valid save. The threshold for dab detected is greater than 4.
-    if ((rsqInformation.fastDect > 4) && rsqInformation.valid)
-    {
-      //increase memory allocation, in C use type cast for realloc to supress warning of void*. Start with +1
-      indexListHeader.indexList = (indexList_t*) realloc(indexListHeader.indexList, (numberIndicesValid + 1) * sizeof(indexList_t));
+  //remember start index
+  rsqInformation_t rsqInformation;
+  readRsqInformation(rsqInformation);
 
-      //write valid index in list
-      indexListHeader.indexList[numberIndicesValid].index = rsqInformation.index;
-      indexListHeader.indexList[numberIndicesValid].valid = 1;
-      indexListHeader.indexList[numberIndicesValid].frequency = rsqInformation.frequency;
+  scanJob.indexStart = rsqInformation.index;
+  scanJob.index = rsqInformation.index;
+  scanJob.up = up;
+  scanJob.found = 0;
+  scanJob.startService = 0;
+  scanJob.directory = 0;
+  scanJob.progress = progress;
 
-      //increase valid frequencies
-      numberIndicesValid++;
-    }
-  }
+  scanJob.start = millis();
+  scanJob.state = SCAN_SEEK;
+}
+
+//Wait for service list in scanJob and start first serviceType
+void beginFirstService(unsigned char serviceType, scanProgress_t progress)
+{
+  cancelScan();
 
-  indexListHeader.size = numberIndicesValid;
+  scanJob.serviceType = serviceType;
+  scanJob.found = 0;
+  scanJob.directory = 0;
+  scanJob.progress = progress;
 
-  //If no valid frequency found return
-  if (numberIndicesValid == 0)
+  scanJob.start = millis();
+  scanJob.lastPoll = micros() - DURATION_SERVICE_LIST_POLL;
+  scanJob.state = SCAN_SERVICE_LIST;
+}
+
+//Start filling service directory with service lists of valid indices in scanJob, band scan first if list is empty
+void beginDirectoryScan(indexListHeader_t& indexListHeader, scanProgress_t progress)
+{
+  if (indexListHeader.size == 0)
   {
-    delete[]indexListHeader.indexList;
-    indexListHeader.indexList = nullptr;
-    indexListHeader.size = 0;
+    beginScan(indexListHeader, progress, false);
+    scanJob.directory = 1;
+    return;
+  }
+
+  cancelScan();
+
+  scanJob.indexListHeader = &indexListHeader;
+  scanJob.progress = progress;
+  scanJob.startService = 0;
+  scanJob.directory = 1;
+  beginDirectoryFill();
+}
+
+//Tune first valid index of band scan for service directory, idle if there is none
+void beginDirectoryFill()
+{
+  scanJob.entry = 0;
+  scanJob.directory = 0;
+
+  if (scanJob.indexListHeader->size == 0)
+  {
+    scanJob.state = SCAN_IDLE;
+    return;
+  }
+
+  scanJob.index = scanJob.indexListHeader->indexList[0].index;
+  scanJob.state = SCAN_DIRECTORY;
+}
+
+//Progress callback of scanJob
+void scanProgress(unsigned char event)
+{
+  if (scanJob.progress != nullptr) scanJob.progress(scanJob, event);
+}
+
+//Next index of seek with wrap around
+unsigned char nextSeekIndex(unsigned char index)
+{
+  if (scanJob.up) return index + 1 >= scanJob.numberIndices ? 0 : index + 1;
+
+  return index == 0 ? scanJob.numberIndices - 1 : index - 1;
+}
+
+//Next candidate of fast detect phase from index on, numberIndices if none
+unsigned char nextCandidate(unsigned char index)
+{
+  while (index < scanJob.numberIndices && (scanJob.candidates[index / 8] >> (index % 8) & 1) == 0) index++;
+
+  return index;
+}
+
+//Send DAB_TUNE_FREQ of scanJob.index without waiting
+void startScanTune()
+{
+  writeTuneIndex(scanJob.index);
+  scanJob.startTune = millis();
+  scanJob.lastPoll = micros();
+  scanJob.tuning = 1;
+  scanJob.cancelled = 0;
+}
+
+//Seek tune complete or timeout without blocking, clears STCINT
+bool pollScanTune(rsqInformation_t& rsqInformation)
+{
+  unsigned short timeout = scanJob.state == SCAN_FAST ? (unsigned short)FAST_SCAN_TIMEOUT : (unsigned short)TIMEOUT_TUNE;
+  bool timedOut = millis() - scanJob.startTune >= timeout;
+
+  //status is read if INTB is asserted or poll is due, INTB signals only STCINT while tuning
+  bool interrupt = readInterrupt();
+  if (!timedOut && !interrupt && micros() - scanJob.lastPoll < DURATION_STC_POLL) return false;
+  scanJob.lastPoll = micros();
+
+  unsigned char buf[4] = {0xff, 0xff, 0xff, 0xff};
+  readReply(buf, sizeof(buf));
+  if ((buf[0] & 1) == 0 && !timedOut) return false;
+
+  //tune of cancelled scan is not measured
+  if (!scanJob.cancelled)
+  {
+    tuneStatistics.index = scanJob.index;
+    tuneStatistics.complete = buf[0] & 1;
+    tuneStatistics.interrupt = interrupt;
+    tuneStatistics.latency = millis() - scanJob.startTune;
+  }
+  scanJob.tuning = 0;
+
+  //Clear STCINT, else INTB stays asserted
+  clearSeekTuneComplete(rsqInformation);
+  return true;
+}
+
+//End of band scan or seek, start first service or idle
+void finishScan()
+{
+  scanProgress(SCAN_EVENT_DONE);
+
+  //service lists of valid indices into service directory
+  if (scanJob.directory)
+  {
+    beginDirectoryFill();
+    return;
+  }
+
+  if (scanJob.startService && scanJob.found != 0)
+  {
+    //tune best valid index of band scan, list is ranked by score
+    index = scanJob.indexListHeader->indexList[0].index;
+    tuneIndex(index);
+
+    scanJob.found = 0;
+    scanJob.start = millis();
+    scanJob.lastPoll = micros() - DURATION_SERVICE_LIST_POLL;
+    scanJob.state = SCAN_SERVICE_LIST;
+    return;
+  }
+
+  scanJob.state = SCAN_IDLE;
+}
+
+//One step of scanJob, call in loop, true while scan is running
+bool pollScan()
+{
+  //pending tune of cancelled scan, STCINT is cleared without blocking
+  if (scanJob.tuning && scanJob.cancelled)
+  {
+    rsqInformation_t rsqInformation;
+    if (pollScanTune(rsqInformation)) scanJob.cancelled = 0;
+    return scanJob.state != SCAN_IDLE;
+  }
+
+  if (scanJob.state == SCAN_IDLE) return false;
+
+  //Wait for service list of valid index and store it in service directory
+  if (scanJob.state == SCAN_DIRECTORY_LIST)
+  {
+    if (micros() - scanJob.lastPoll < DURATION_SERVICE_LIST_POLL) return true;
+    scanJob.lastPoll = micros();
+
+    eventInformation_t eventInformation;
+    readEventInformation(eventInformation);
+
+    if (eventInformation.serviceListAvailable == 1)
+    {
+      //updateEnsemble() stores services of parsed ensemble in directory
+      scanProgress(updateEnsemble(ensembleHeader) ? SCAN_EVENT_DIRECTORY : SCAN_EVENT_INDEX);
+    }
+    else if (millis() - scanJob.start >= TIMEOUT_SERVICE_LIST)
+    {
+      scanProgress(SCAN_EVENT_INDEX);
+    }
+    else
+    {
+      return true;
+    }
+
+    //next valid index
+    if (++scanJob.entry < scanJob.indexListHeader->size)
+    {
+      scanJob.index = scanJob.indexListHeader->indexList[scanJob.entry].index;
+      scanJob.state = SCAN_DIRECTORY;
+      return true;
+    }
+
+    scanProgress(SCAN_EVENT_DONE);
+    scanJob.state = SCAN_IDLE;
+    return false;
+  }
+
+  //Wait for service list
+  if (scanJob.state == SCAN_SERVICE_LIST)
+  {
+    if (micros() - scanJob.lastPoll < DURATION_SERVICE_LIST_POLL) return true;
+    scanJob.lastPoll = micros();
+
+    eventInformation_t eventInformation;
+    readEventInformation(eventInformation);
+
+    if (eventInformation.serviceListAvailable == 1)
+    {
+      startFirstService(serviceId, componentId, scanJob.serviceType);
+      scanJob.found = ensembleHeader.numServices != 0;
+    }
+    else if (millis() - scanJob.start >= TIMEOUT_SERVICE_LIST)
+    {
+      Serial.println(F("Error ServList"));
+    }
+    else
+    {
+      return true;
+    }
+
+    scanJob.state = SCAN_IDLE;
+    scanProgress(SCAN_EVENT_SERVICE);
+    return false;
+  }
+
+  //Band scan or seek, first step tunes
+  if (!scanJob.tuning)
+  {
+    if (scanJob.state == SCAN_SEEK) scanJob.index = nextSeekIndex(scanJob.index);
+    startScanTune();
+    return true;
+  }
 
+  rsqInformation_t rsqInformation;
+  if (!pollScanTune(rsqInformation)) return true;
+
+  //DAB found and valid if threshold for dab detected is greater than 4
+  bool dab = rsqInformation.fastDect > FAST_DETECT_THRESHOLD;
+
+  if (scanJob.state == SCAN_FAST)
+  {
+    if (dab)
+    {
+      scanJob.candidates[scanJob.index / 8] |= 1 << (scanJob.index % 8);
+      scanStatistics.candidates++;
+    }
+    scanProgress(dab ? SCAN_EVENT_CANDIDATE : SCAN_EVENT_INDEX);
+
+    //next index
+    if (++scanJob.index < scanJob.numberIndices && scanJob.index < MAX_INDEX) return true;
+
+    scanStatistics.durationFast = millis() - scanJob.start;
+
+    //Restore properties for normal tuning
+    writePropertyValue(DAB_VALID_ACQ_TIME, scanJob.acqTime);
+    writePropertyValue(DAB_VALID_SYNC_TIME, scanJob.syncTime);
+
+    //Phase 2: full acquisition only on candidates
+    scanJob.start = millis();
+    scanJob.index = nextCandidate(0);
+    scanJob.state = SCAN_FULL;
+  }
+  else if (scanJob.state == SCAN_FULL)
+  {
+    if (dab && rsqInformation.valid)
+    {
+      //signal quality of valid index
+      indexList_t indexList;
+      indexList.index      = rsqInformation.index;
+      indexList.valid      = 1;
+      indexList.frequency  = rsqInformation.frequency;
+      indexList.rssi       = rsqInformation.rssi;
+      indexList.snr        = rsqInformation.snr;
+      indexList.cnr        = rsqInformation.cnr;
+      indexList.ficQuality = rsqInformation.ficQuality;
+      indexList.fastDect   = rsqInformation.fastDect;
+      indexList.score      = scoreIndex(indexList);
+
+      //ranked by score
+      insertIndex(*scanJob.indexListHeader, indexList);
+
+      scanJob.found++;
+      scanStatistics.valid++;
+    }
+    scanProgress(dab && rsqInformation.valid ? SCAN_EVENT_VALID : SCAN_EVENT_INDEX);
+
+    scanJob.index = nextCandidate(scanJob.index + 1);
+  }
+  else if (scanJob.state == SCAN_DIRECTORY)
+  {
+    //tuned, wait for service list
+    scanJob.start = millis();
+    scanJob.lastPoll = micros() - DURATION_SERVICE_LIST_POLL;
+    scanJob.state = SCAN_DIRECTORY_LIST;
+    return true;
+  }
+  else
+  {
+    if (dab && rsqInformation.valid)
+    {
+      scanJob.found = 1;
+      scanProgress(SCAN_EVENT_VALID);
+    }
+    else
+    {
+      scanProgress(SCAN_EVENT_INDEX);
+    }
+
+    //valid or around
+    if (scanJob.found == 0 && scanJob.index != scanJob.indexStart) return true;
+
+    index = scanJob.index;
+    finishScan();
+    return scanJob.state != SCAN_IDLE;
+  }
+
+  //band scan done
+  if (scanJob.state == SCAN_FULL && scanJob.index >= scanJob.numberIndices)
+  {
+    scanStatistics.durationFull = millis() - scanJob.start;
+    //no more valid indices of this scan
+    trimIndexList(*scanJob.indexListHeader);
+    finishScan();
+  }
+
+  return scanJob.state != SCAN_IDLE;
+}
+
+//Score of signal quality with qualityWeights
+int16_t scoreIndex(const indexList_t& indexList)
+{
+  return qualityWeights.rssi * indexList.rssi
+         + qualityWeights.snr * indexList.snr
+         + qualityWeights.cnr * indexList.cnr
+         + qualityWeights.ficQuality * indexList.ficQuality
+         + qualityWeights.fastDect * indexList.fastDect;
+}
+
+//Insert valid index by score, replaces worst index if table is full, false if worse than all
+bool insertIndex(indexListHeader_t& indexListHeader, const indexList_t& indexList)
+{
+  uint8_t i = indexListHeader.size;
+
+#ifdef DAB_FIXED_INDEX_LIST
+  uint8_t capacity = MAX_VALID_INDICES;
+#else
+  //allocated by beginScan(), no table if heap was exhausted
+  uint8_t capacity = indexListHeader.capacity;
+#endif
+
+  //full, worst index is dropped
+  if (i == capacity)
+  {
+    if (i == 0 || indexList.score <= indexListHeader.indexList[i - 1].score) return false;
+    i--;
+  }
+  else
+  {
+    indexListHeader.size++;
+  }
+
+  //insertion sort, best first, equal scores keep order of scan
+  while (i > 0 && indexListHeader.indexList[i - 1].score < indexList.score)
+  {
+    indexListHeader.indexList[i] = indexListHeader.indexList[i - 1];
+    i--;
+  }
+  indexListHeader.indexList[i] = indexList;
+
+  return true;
+}
+
+//Score all indices again and sort, best first, after qualityWeights changed
+void rankIndexList(indexListHeader_t& indexListHeader)
+{
+  uint8_t size = indexListHeader.size;
+  indexListHeader.size = 0;
+
+  for (uint8_t j = 0; j < size; j++)
+  {
+    indexList_t indexList = indexListHeader.indexList[j];
+    indexList.score = scoreIndex(indexList);
+    insertIndex(indexListHeader, indexList);
+  }
+}
+
+//Frees unused entries of table on heap after scan
+void trimIndexList(indexListHeader_t& indexListHeader)
+{
+#ifndef DAB_FIXED_INDEX_LIST
+  if (indexListHeader.capacity == indexListHeader.size) return;
+
+  if (indexListHeader.size == 0)
+  {
+    free(indexListHeader.indexList);
+    indexListHeader.indexList = nullptr;
+    indexListHeader.capacity = 0;
     return;
   }
+
+  //shrinking keeps the block in place, in C use type cast for realloc to supress warning of void*
+  indexList_t* indexListTrimmed = (indexList_t*) realloc(indexListHeader.indexList, indexListHeader.size * sizeof(indexList_t));
+  if (indexListTrimmed == nullptr) return;
+  indexListHeader.indexList = indexListTrimmed;
+  indexListHeader.capacity = indexListHeader.size;
+#else
+  (void) indexListHeader;
+#endif
+}
+
+//Stop scanJob without waiting, STCINT of pending tune is cleared by pollScan(), found indices are kept
+void cancelScan()
+{
+  if (scanJob.state == SCAN_IDLE) return;
+
+  //pending tune is completed by pollScan() or next tuneIndex()
+  if (scanJob.tuning) scanJob.cancelled = 1;
+
+  //Restore properties for normal tuning
+  if (scanJob.state == SCAN_FAST)
+  {
+    writePropertyValue(DAB_VALID_ACQ_TIME, scanJob.acqTime);
+    writePropertyValue(DAB_VALID_SYNC_TIME, scanJob.syncTime);
+  }
+
+  //insertIndex() is done
+  if (scanJob.state == SCAN_FAST || scanJob.state == SCAN_FULL) trimIndexList(*scanJob.indexListHeader);
+
+  scanJob.state = SCAN_IDLE;
+  scanProgress(SCAN_EVENT_CANCEL);
 }
 
 //Tune index up/down
@@ -2171,3 +3292,654 @@ void tune(unsigned char &index, bool up)
 
   index = rsqInformation.index;
 }
+
+//Find active sector of service directory in flash and build RAM index of valid entries
+void beginServiceDirectory()
+{
+  serviceDirectory.count = 0;
+  serviceDirectory.sector = 0;
+  serviceDirectory.sequence = 0;
+  serviceDirectory.size = 0;
+
+  //header of both sectors, marker and sequence
+  unsigned char header[2][2];
+  readFlash(getDirectoryAddress(0, 0), header[0], sizeof(header[0]));
+  readFlash(getDirectoryAddress(1, 0), header[1], sizeof(header[1]));
+
+  bool valid0 = header[0][0] == DIRECTORY_HEADER;
+  bool valid1 = header[1][0] == DIRECTORY_HEADER;
+
+  //not formatted, header is written with first entry
+  if (!valid0 && !valid1) return;
+
+  //Copy of compaction gets header last, higher sequence is newer
+  if (!valid0 || (valid1 && (unsigned char)(header[1][1] - header[0][1]) < 0x80)) serviceDirectory.sector = 1;
+  serviceDirectory.sequence = header[serviceDirectory.sector][1];
+  serviceDirectory.count = 1;
+
+  directoryEntry_t entry;
+  for (unsigned char slot = 1; slot < DIRECTORY_ENTRIES; slot++)
+  {
+    unsigned char state;
+    readFlash(getDirectoryAddress(serviceDirectory.sector, slot), &state, 1);
+
+    //entries are appended, first empty entry is end
+    if (state == DIRECTORY_EMPTY) break;
+
+    serviceDirectory.count++;
+
+    if (state == DIRECTORY_VALID && readDirectoryEntry(slot, entry))
+    {
+      insertDirectoryKey(hashDirectoryService(entry.serviceId), checkDirectoryEntry(entry), slot);
+    }
+  }
+}
+
+//Address of slot in sector of service directory
+unsigned long getDirectoryAddress(unsigned char sector, unsigned char slot)
+{
+  return (sector ? ADDRESS_SERVICE_DIRECTORY_COPY : ADDRESS_SERVICE_DIRECTORY) + (unsigned long)slot * DIRECTORY_ENTRY_SIZE;
+}
+
+//Read entry of active sector of service directory, true if valid
+bool readDirectoryEntry(unsigned char slot, directoryEntry_t& entry)
+{
+  unsigned char buf[DIRECTORY_ENTRY_SIZE];
+
+  if (slot == 0 || slot >= serviceDirectory.count) return false;
+
+  readFlash(getDirectoryAddress(serviceDirectory.sector, slot), buf, sizeof(buf));
+
+  entry.index       = buf[1];
+  entry.ensembleId  = (unsigned short)buf[3] << 8 | buf[2];
+  entry.serviceId   = (unsigned long)buf[7] << 24 | (unsigned long)buf[6] << 16 | (unsigned long)buf[5] << 8 | buf[4];
+  entry.componentId = (unsigned short)buf[9] << 8 | buf[8];
+  entry.programType = buf[10];
+  memcpy(entry.label, &buf[12], 16);
+  entry.label[16] = '\0';
+
+  return buf[0] == DIRECTORY_VALID;
+}
+
+//Key of serviceId in RAM index
+unsigned char hashDirectoryService(unsigned long serviceId)
+{
+  return serviceId ^ serviceId >> 8 ^ serviceId >> 16 ^ serviceId >> 24;
+}
+
+//Checksum of all fields of entry, unchanged entries are found without reading flash
+unsigned char checkDirectoryEntry(const directoryEntry_t& entry)
+{
+  unsigned char check = entry.index;
+  check = check * 31 + (entry.ensembleId >> 8);
+  check = check * 31 + (entry.ensembleId & 0xff);
+  for (unsigned char i = 0; i < 4; i++) check = check * 31 + (entry.serviceId >> (8 * i) & 0xff);
+  check = check * 31 + (entry.componentId >> 8);
+  check = check * 31 + (entry.componentId & 0xff);
+  check = check * 31 + entry.programType;
+  for (unsigned char i = 0; i < 16 && entry.label[i] != '\0'; i++) check = check * 31 + entry.label[i];
+
+  return check;
+}
+
+//First key with hash in RAM index or position to insert
+unsigned char lowerDirectoryKey(unsigned char hash)
+{
+  unsigned char low = 0;
+  unsigned char high = serviceDirectory.size;
+
+  while (low < high)
+  {
+    unsigned char middle = (low + high) / 2;
+    if (serviceDirectory.keys[middle].hash < hash) low = middle + 1;
+    else high = middle;
+  }
+  return low;
+}
+
+//Insert key of valid entry sorted by hash, false if index is full
+bool insertDirectoryKey(unsigned char hash, unsigned char check, unsigned char slot)
+{
+  if (serviceDirectory.size == MAX_DIRECTORY_KEYS) return false;
+
+  unsigned char position = lowerDirectoryKey(hash);
+  for (unsigned char k = serviceDirectory.size; k > position; k--) serviceDirectory.keys[k] = serviceDirectory.keys[k - 1];
+
+  serviceDirectory.keys[position].hash = hash;
+  serviceDirectory.keys[position].check = check;
+  serviceDirectory.keys[position].slot = slot;
+  serviceDirectory.size++;
+
+  return true;
+}
+
+//Find key of serviceId and componentId (DIRECTORY_ANY_COMPONENT for first component), size of index if not found
+unsigned char findDirectoryKey(unsigned long serviceId, unsigned short componentId, directoryEntry_t& entry)
+{
+  unsigned char hash = hashDirectoryService(serviceId);
+
+  //only entries with same hash are read from flash
+  for (unsigned char k = lowerDirectoryKey(hash); k < serviceDirectory.size && serviceDirectory.keys[k].hash == hash; k++)
+  {
+    if (readDirectoryEntry(serviceDirectory.keys[k].slot, entry) && entry.serviceId == serviceId
+        && (componentId == DIRECTORY_ANY_COMPONENT || entry.componentId == componentId)) return k;
+  }
+  return serviceDirectory.size;
+}
+
+//Find valid entry of serviceId and componentId in service directory
+bool findDirectoryService(unsigned long serviceId, directoryEntry_t& entry, unsigned char& slot, unsigned short componentId)
+{
+  unsigned char k = findDirectoryKey(serviceId, componentId, entry);
+  if (k == serviceDirectory.size) return false;
+
+  slot = serviceDirectory.keys[k].slot;
+  return true;
+}
+
+//Erase sector and write header, entries follow from slot 1
+void formatServiceDirectory(unsigned char sector, unsigned char sequence)
+{
+  eraseFlash(getDirectoryAddress(sector, 0));
+
+  unsigned char header[2] = {DIRECTORY_HEADER, sequence};
+  writeFlash(getDirectoryAddress(sector, 0), header, sizeof(header));
+
+  serviceDirectory.sector = sector;
+  serviceDirectory.sequence = sequence;
+  serviceDirectory.count = 1;
+}
+
+//Copy valid entries into other sector, old sector stays until next compaction
+void compactServiceDirectory()
+{
+  unsigned char buf[DIRECTORY_ENTRY_SIZE];
+  unsigned char sector = serviceDirectory.sector;
+  unsigned char other = sector ^ 1;
+
+  eraseFlash(getDirectoryAddress(other, 0));
+
+  //order of keys is kept, only slots change
+  for (unsigned char k = 0; k < serviceDirectory.size; k++)
+  {
+    readFlash(getDirectoryAddress(sector, serviceDirectory.keys[k].slot), buf, sizeof(buf));
+    writeFlash(getDirectoryAddress(other, k + 1), buf, sizeof(buf));
+    serviceDirectory.keys[k].slot = k + 1;
+  }
+
+  //header last, incomplete copy is not used at next begin
+  unsigned char header[2] = {DIRECTORY_HEADER, (unsigned char)(serviceDirectory.sequence + 1)};
+  writeFlash(getDirectoryAddress(other, 0), header, sizeof(header));
+
+  serviceDirectory.sector = other;
+  serviceDirectory.sequence++;
+  serviceDirectory.count = serviceDirectory.size + 1;
+}
+
+//Append entry to service directory if new or changed
+void writeDirectoryService(directoryEntry_t& entry)
+{
+  unsigned char hash = hashDirectoryService(entry.serviceId);
+  unsigned char check = checkDirectoryEntry(entry);
+
+  unsigned char buf[DIRECTORY_ENTRY_SIZE];
+  for (unsigned char i = 0; i < sizeof(buf); i++) buf[i] = 0xff;
+
+  buf[0]  = DIRECTORY_VALID;
+  buf[1]  = entry.index;
+  buf[2]  = entry.ensembleId & 0xff;
+  buf[3]  = entry.ensembleId >> 8;
+  buf[4]  = entry.serviceId & 0xff;
+  buf[5]  = entry.serviceId >> 8 & 0xff;
+  buf[6]  = entry.serviceId >> 16 & 0xff;
+  buf[7]  = entry.serviceId >> 24;
+  buf[8]  = entry.componentId & 0xff;
+  buf[9]  = entry.componentId >> 8;
+  buf[10] = entry.programType;
+  memcpy(&buf[12], entry.label, 16);
+
+  //unchanged, no flash write, 8 bit hash and check can collide so the stored slot is compared
+  for (unsigned char k = lowerDirectoryKey(hash); k < serviceDirectory.size && serviceDirectory.keys[k].hash == hash; k++)
+  {
+    if (serviceDirectory.keys[k].check != check) continue;
+
+    unsigned char stored[DIRECTORY_ENTRY_SIZE];
+    readFlash(getDirectoryAddress(serviceDirectory.sector, serviceDirectory.keys[k].slot), stored, sizeof(stored));
+    if (memcmp(stored, buf, sizeof(buf)) == 0) return;
+  }
+
+  directoryEntry_t stored;
+  unsigned char k = findDirectoryKey(entry.serviceId, entry.componentId, stored);
+
+  if (k < serviceDirectory.size)
+  {
+    //mark old entry as replaced, bits 1 to 0 need no erase
+    unsigned char state = DIRECTORY_DELETED;
+    writeFlash(getDirectoryAddress(serviceDirectory.sector, serviceDirectory.keys[k].slot), &state, 1);
+
+    serviceDirectory.size--;
+    for (; k < serviceDirectory.size; k++) serviceDirectory.keys[k] = serviceDirectory.keys[k + 1];
+  }
+  //index full, service is not stored
+  else if (serviceDirectory.size == MAX_DIRECTORY_KEYS)
+  {
+    return;
+  }
+
+  //not formatted yet
+  if (serviceDirectory.count == 0) formatServiceDirectory(0, 0);
+
+  //sector full, deleted entries are dropped
+  if (serviceDirectory.count >= DIRECTORY_ENTRIES) compactServiceDirectory();
+
+  writeFlash(getDirectoryAddress(serviceDirectory.sector, serviceDirectory.count), buf, sizeof(buf));
+
+  insertDirectoryKey(hash, check, serviceDirectory.count);
+  serviceDirectory.count++;
+}
+
+//Store stored components of services of parsed ensemble in service directory
+void storeEnsembleInDirectory(ensembleHeader_t& ensembleHeader, unsigned char index, unsigned short ensembleId)
+{
+  for (unsigned char i = 0; i < ensembleHeader.numServices; i++)
+  {
+    directoryEntry_t entry;
+    entry.serviceId   = getServiceId(i);
+    entry.ensembleId  = ensembleId;
+    entry.index       = index;
+    entry.programType = getProgramType(i);
+
+    //label padded with '\0'
+    for (unsigned char j = 0; j < sizeof(entry.label); j++) entry.label[j] = '\0';
+    const char* label = getServiceLabel(i);
+    if (label != nullptr) strncpy(entry.label, label, 16);
+
+    //without component service can not be started
+    for (unsigned char j = 0; j < getNumComponents(i); j++)
+    {
+      entry.componentId = getComponentId(i, j);
+      writeDirectoryService(entry);
+    }
+  }
+}
+
+//Tune and start serviceId of service directory, first component if componentId is DIRECTORY_ANY_COMPONENT
+bool startDirectoryService(unsigned long id, unsigned short component)
+{
+  directoryEntry_t entry;
+  unsigned char slot;
+
+  if (!findDirectoryService(id, entry, slot, component)) return false;
+
+  //global vars
+  index = entry.index;
+  serviceId = entry.serviceId;
+  componentId = entry.componentId;
+
+  tuneIndex(index);
+  startService(serviceId, componentId);
+
+  return true;
+}
+
+//Tune and start next service of service directory after actual service and component
+bool nextDirectoryService()
+{
+  directoryEntry_t entry;
+
+  //start after actual service, else with first key
+  unsigned char k = findDirectoryKey(serviceId, componentId, entry);
+  k = k < serviceDirectory.size ? k + 1 : 0;
+
+  for (unsigned char i = 0; i < serviceDirectory.size; i++, k++)
+  {
+    if (k >= serviceDirectory.size) k = 0;
+
+    if (readDirectoryEntry(serviceDirectory.keys[k].slot, entry) && (entry.serviceId != serviceId || entry.componentId != componentId))
+    {
+      return startDirectoryService(entry.serviceId, entry.componentId);
+    }
+  }
+  return false;
+}
+
+//Sub-channels of all components of parsed ensemble sorted by start CU, only read again for other ensemble or version
+bool analyzeCif(cifMap_t& cifMap)
+{
+  if (!updateEnsemble(ensembleHeader)) return false;
+
+  //decoded CUs change with reception, sub-channels only with ensemble or version
+  rsqInformation_t rsqInformation;
+  readRsqInformation(rsqInformation);
+  cifMap.cuLevel = rsqInformation.cuLevel;
+
+  //same ensemble and version, no queries
+  if (cifMap.valid && cifMap.ensembleId == ensembleCache.ensembleId && cifMap.version == ensembleCache.version) return true;
+
+  cifMap.valid = 0;
+  cifMap.size = 0;
+  cifMap.dropped = 0;
+  cifMap.overlaps = 0;
+
+  for (unsigned char i = 0; i < ensembleHeader.numServices; i++)
+  {
+    for (unsigned char j = 0; j < getNumComponents(i); j++)
+    {
+      unsigned long id = getServiceId(i);
+      unsigned long component = getComponentId(i, j);
+
+      componentTechnicalInformation_t componentTechnicalInformation;
+      readComponentTechnicalInformation(componentTechnicalInformation, id, component);
+
+      //components of packet mode share sub-channel
+      unsigned char k = 0;
+      while (k < cifMap.size && cifMap.subchannels[k].addressCU < componentTechnicalInformation.addressCU) k++;
+
+      if (k < cifMap.size && cifMap.subchannels[k].addressCU == componentTechnicalInformation.addressCU
+          && cifMap.subchannels[k].numberCU == componentTechnicalInformation.numberCU)
+      {
+        cifMap.subchannels[k].components++;
+        continue;
+      }
+
+      if (cifMap.size == MAX_NUMBER_SUBCHANNELS)
+      {
+        cifMap.dropped++;
+        continue;
+      }
+
+      //insert sorted by start CU
+      for (unsigned char l = cifMap.size; l > k; l--) cifMap.subchannels[l] = cifMap.subchannels[l - 1];
+      cifMap.size++;
+
+      subchannel_t& subchannel = cifMap.subchannels[k];
+      subchannel.addressCU      = componentTechnicalInformation.addressCU;
+      subchannel.numberCU       = componentTechnicalInformation.numberCU;
+      subchannel.bitRate        = componentTechnicalInformation.bitRate;
+      subchannel.protectionInfo = componentTechnicalInformation.protectionInfo;
+      subchannel.serviceMode    = componentTechnicalInformation.serviceMode;
+      subchannel.components     = 1;
+    }
+  }
+
+  //used CUs without overlapping parts
+  unsigned short endCU = 0;
+  unsigned short usedCU = 0;
+  for (unsigned char k = 0; k < cifMap.size; k++)
+  {
+    unsigned short startCU = cifMap.subchannels[k].addressCU;
+    unsigned short stopCU = startCU + cifMap.subchannels[k].numberCU;
+
+    if (startCU < endCU) cifMap.overlaps++;
+    if (startCU < endCU) startCU = endCU;
+    if (stopCU > startCU) usedCU += stopCU - startCU;
+    if (stopCU > endCU) endCU = stopCU;
+  }
+  cifMap.freeCU = usedCU < CIF_SIZE_CU ? CIF_SIZE_CU - usedCU : 0;
+
+  cifMap.ensembleId = ensembleCache.ensembleId;
+  cifMap.version = ensembleCache.version;
+  cifMap.valid = 1;
+
+  return true;
+}
+
+//Checksum of components, type and label of service to find changed services
+unsigned short hashService(unsigned char service)
+{
+  unsigned short hash = getNumComponents(service) << 8 | getDataFlag(service) << 5 | getProgramType(service);
+
+  for (unsigned char j = 0; j < getNumComponents(service); j++)
+  {
+    hash = hash * 31 + getComponentId(service, j);
+    hash = hash * 31 + getComponentType(service, j);
+  }
+
+  const char* label = getServiceLabel(service);
+  while (label != nullptr && *label != '\0') hash = hash * 31 + *label++;
+
+  return hash;
+}
+
+//Read service list again, diff with cached list and keep or move actual service, true if actual service is kept
+bool handleReconfiguration()
+{
+  ensembleDiff.added = 0;
+  ensembleDiff.removed = 0;
+  ensembleDiff.changed = 0;
+  ensembleDiff.serviceKept = 0;
+
+  //Cached services in order of serviceId
+  unsigned long serviceIds[MAX_NUMBER_SERVICES];
+  unsigned short hashes[MAX_NUMBER_SERVICES];
+  unsigned char numServices = ensembleCache.valid ? ensembleHeader.numServices : 0;
+
+  for (unsigned char rank = 0; rank < numServices; rank++)
+  {
+    serviceIds[rank] = getServiceId(ensembleArena.order[rank]);
+    hashes[rank] = hashService(ensembleArena.order[rank]);
+  }
+
+  //Only service list, tuning and running service stay, event is acknowledged already so list is parsed again
+  ensembleCache.valid = 0;
+  if (!updateEnsemble(ensembleHeader, ensembleCache.serviceType)) return false;
+
+  //Diff both sorted lists
+  unsigned char oldRank = 0;
+  unsigned char newRank = 0;
+  while (oldRank < numServices || newRank < ensembleHeader.numServices)
+  {
+    if (newRank == ensembleHeader.numServices)
+    {
+      ensembleDiff.removed++;
+      oldRank++;
+      continue;
+    }
+
+    unsigned char service = ensembleArena.order[newRank];
+
+    if (oldRank == numServices || getServiceId(service) < serviceIds[oldRank])
+    {
+      ensembleDiff.added++;
+      newRank++;
+    }
+    else if (getServiceId(service) > serviceIds[oldRank])
+    {
+      ensembleDiff.removed++;
+      oldRank++;
+    }
+    else
+    {
+      if (hashService(service) != hashes[oldRank]) ensembleDiff.changed++;
+      oldRank++;
+      newRank++;
+    }
+  }
+
+  //Actual service and component still in ensemble, keep running
+  if (searchService(serviceId, componentId))
+  {
+    ensembleDiff.serviceKept = 1;
+    return true;
+  }
+
+  //Service is still there with other components, else nearest service in order of serviceId
+  unsigned char rank;
+  findService(ensembleHeader, serviceId, rank);
+  if (rank >= ensembleHeader.numServices) rank = ensembleHeader.numServices - 1;
+
+  //Services without components can not be started, take next one in order of serviceId
+  unsigned char step = 0;
+  while (step < ensembleHeader.numServices && getNumComponents(ensembleArena.order[(rank + step) % ensembleHeader.numServices]) == 0) step++;
+  if (step == ensembleHeader.numServices) return false;
+  rank = (rank + step) % ensembleHeader.numServices;
+
+  ensembleArena.actualRank = rank;
+  ensembleHeader.actualService = ensembleArena.order[rank];
+
+  //global var
+  serviceId = getServiceId(ensembleHeader.actualService);
+  componentId = getComponentId(ensembleHeader.actualService, 0);
+
+  startService(serviceId, componentId);
+
+  return false;
+}
+
+//Check events for reconfiguration of ensemble, call in loop
+void checkReconfiguration()
+{
+  static unsigned long lastCheck = 0;
+
+  //no parsed ensemble to keep up to date
+  if (ensembleCache.valid == 0 || ensembleCache.snapshot == 1) return;
+
+  //retuned, events belong to other ensemble until updateEnsemble() checked its id
+  if (ensembleCache.checkEnsemble == 1) return;
+
+  if (micros() - lastCheck < DURATION_RECONFIG_CHECK) return;
+  lastCheck = micros();
+
+  eventInformation_t eventInformation;
+  readEventInformation(eventInformation);
+
+  //new version of service list or reconfiguration
+  if (eventInformation.ensembleReconfigInterrupt == 1
+      || (eventInformation.serviceListAvailable == 1 && eventInformation.currentServiceListVersion != ensembleCache.version))
+  {
+    //acknowledge reconfiguration before list is read, reconfiguration during read interrupts again
+    readEventInformation(eventInformation, 1);
+
+    handleReconfiguration();
+    serialPrintSi468x::dabPrintEnsembleDiff(ensembleDiff);
+  }
+}
+
+//Write parsed ensemble to flash if it is not stored yet
+void saveEnsembleSnapshot()
+{
+  unsigned char header[SNAPSHOT_HEADER_SIZE];
+  unsigned char stored[SNAPSHOT_HEADER_SIZE];
+  for (unsigned char i = 0; i < sizeof(header); i++) header[i] = 0xff;
+
+  header[0] = SNAPSHOT_VALID;
+  header[1] = ensembleCache.index;
+  header[2] = ensembleCache.ensembleId & 0xff;
+  header[3] = ensembleCache.ensembleId >> 8;
+  header[4] = ensembleCache.version & 0xff;
+  header[5] = ensembleCache.version >> 8;
+  header[6] = ensembleHeader.numServices;
+  header[7] = ensembleCache.serviceType;
+  header[8] = sizeof(ensembleArena_t) & 0xff;
+  header[9] = sizeof(ensembleArena_t) >> 8;
+
+  //same ensemble and version already stored, no flash write
+  readFlash(ADDRESS_ENSEMBLE_SNAPSHOT, stored, sizeof(stored));
+  if (memcmp(header, stored, 10) == 0) return;
+
+  unsigned char* data = (unsigned char*) &ensembleArena;
+  unsigned long crc32 = updateCrc32(0, data, sizeof(ensembleArena_t));
+  header[12] = crc32 & 0xff;
+  header[13] = crc32 >> 8 & 0xff;
+  header[14] = crc32 >> 16 & 0xff;
+  header[15] = crc32 >> 24;
+
+  eraseFlash(ADDRESS_ENSEMBLE_SNAPSHOT);
+
+  //arena pagewise, header last so an interrupted write stays invalid
+  unsigned long address = ADDRESS_ENSEMBLE_SNAPSHOT + SNAPSHOT_HEADER_SIZE;
+  unsigned short offset = 0;
+  while (offset < sizeof(ensembleArena_t))
+  {
+    unsigned short len = FLASH_PAGE_SIZE - (address + offset) % FLASH_PAGE_SIZE;
+    if (sizeof(ensembleArena_t) - offset < len) len = sizeof(ensembleArena_t) - offset;
+
+    writeFlash(address + offset, &data[offset], len);
+    offset += len;
+  }
+
+  writeFlash(ADDRESS_ENSEMBLE_SNAPSHOT, header, sizeof(header));
+}
+
+//Index of stored snapshot, index is unchanged if there is no valid snapshot
+bool readEnsembleSnapshotIndex(unsigned char& index)
+{
+  unsigned char header[SNAPSHOT_HEADER_SIZE];
+  readFlash(ADDRESS_ENSEMBLE_SNAPSHOT, header, sizeof(header));
+
+  //other layout of arena, restore would fail
+  if (header[0] != SNAPSHOT_VALID || header[1] >= MAX_INDEX || header[6] == 0 || header[6] > MAX_NUMBER_SERVICES
+      || ((unsigned short)header[9] << 8 | header[8]) != sizeof(ensembleArena_t)) return false;
+
+  index = header[1];
+  return true;
+}
+
+//Restore ensemble of tuned index from flash, true if valid
+bool restoreEnsembleSnapshot()
+{
+  unsigned char header[SNAPSHOT_HEADER_SIZE];
+  readFlash(ADDRESS_ENSEMBLE_SNAPSHOT, header, sizeof(header));
+
+  //other index or other layout of arena
+  if (header[0] != SNAPSHOT_VALID || header[1] != ensembleCache.index || header[6] == 0 || header[6] > MAX_NUMBER_SERVICES
+      || ((unsigned short)header[9] << 8 | header[8]) != sizeof(ensembleArena_t)) return false;
+
+  //arena pagewise, readData works with 0x100
+  unsigned char* data = (unsigned char*) &ensembleArena;
+  unsigned long address = ADDRESS_ENSEMBLE_SNAPSHOT + SNAPSHOT_HEADER_SIZE;
+  unsigned short offset = 0;
+  while (offset < sizeof(ensembleArena_t))
+  {
+    unsigned short len = FLASH_PAGE_SIZE - (address + offset) % FLASH_PAGE_SIZE;
+    if (sizeof(ensembleArena_t) - offset < len) len = sizeof(ensembleArena_t) - offset;
+
+    readFlash(address + offset, &data[offset], len);
+    offset += len;
+  }
+
+  unsigned long crc32 = (unsigned long)header[15] << 24 | (unsigned long)header[14] << 16 | (unsigned long)header[13] << 8 | header[12];
+
+  //components of services follow each other in arena, arena has no pointers
+  unsigned char numComponents = 0;
+  for (unsigned char i = 0; i < header[6]; i++)
+  {
+    if (ensembleArena.firstComponent[i] != numComponents) numComponents = 0xff;
+    else numComponents += getNumComponents(i);
+  }
+
+  //corrupted
+  if (updateCrc32(0, data, sizeof(ensembleArena_t)) != crc32 || numComponents != ensembleArena.numComponents)
+  {
+    clearEnsembleList(ensembleHeader);
+    return false;
+  }
+
+  ensembleHeader.numServices = header[6];
+  ensembleHeader.version = (unsigned short)header[5] << 8 | header[4];
+  ensembleHeader.actualService = 0;
+  ensembleHeader.actualComponent = 0;
+
+  ensembleCache.ensembleId  = (unsigned short)header[3] << 8 | header[2];
+  ensembleCache.version     = ensembleHeader.version;
+  ensembleCache.serviceType = header[7];
+  ensembleCache.valid       = 1;
+  ensembleCache.snapshot    = 1;
+
+  return true;
+}
+
+//Check restored snapshot with service list of device, call in loop
+void checkEnsembleSnapshot()
+{
+  static unsigned long lastCheck = 0;
+
+  if (ensembleCache.snapshot == 0) return;
+
+  if (micros() - lastCheck < DURATION_SNAPSHOT_CHECK) return;
+  lastCheck = micros();
+
+  //Reuses snapshot if ensemble id and version match, else parses service list
+  updateEnsemble(ensembleHeader, ensembleCache.serviceType);
+}
+
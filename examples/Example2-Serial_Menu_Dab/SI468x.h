@@ -19,14 +19,24 @@
   SlaveSelect:  Pin 2
 
   Memory needs
-  UNO
+  UNO, avr-size of sketch before static tables of driver
   ROM:  39856 Bytes (92%)
   RAM:    881 Bytes (43%)
+  Static tables of driver with default build configuration, sizeof of x86-64 host build (host/benchmark),
+  AVR has 16 bit int and pointers and no padding, so its sizes are smaller
+  ensembleArena:          408 Bytes (264 with DAB_LABEL_POOL_SIZE 0, 488 with DAB_MAX_SERVICES 32)
+  frequencyTableHeader:     2 Bytes
+  indexListHeader:         16 Bytes (196 with DAB_FIXED_INDEX_LIST), 16 Bytes per valid index on heap
+  cifMap:                 172 Bytes, cache of analyzeCif()
+  scanJob:                 64 Bytes
+  serviceDirectory:       148 Bytes (4 + 3 * DAB_DIRECTORY_KEYS)
+  old service list:       800 Bytes with 20 services of 4 components on heap
 
   Files
   properties.h - needed for tuner circuit
   firmware.h - needed for flash memory circuit
   Arduino.h - for standard datatypes uint8_t
+  host/ - build for Linux with simulated Si468x and SST26, make in host/, not compiled by Arduino IDE
 
 */
 
@@ -39,17 +49,54 @@
   Changed: uint8_t etc. datatypes - open
   New: create namespaces like driverSi468x to avoid conflicts - open
   loadFirmware generic message handler to avoid PrintSerialFlashSst26 object - open
-  loadFirmware works only with 0x100 because of flash (pagewise)- open
+  loadFirmware works only with 0x100 because of flash (pagewise)- done, pages are collected in packages up to 0x1000
   readStorage() handle first 4 bytes of answer - open
 
   New: readFrequencyInformationTable()- open
-  Changed: use interrupt not delayMicroseconds in functions - open
+  Changed: use interrupt not delayMicroseconds in functions - done
   New: componentInformation_t userAppData - open
   New: Create class - open
   New: use onboard flash for program types string - open
   New: use onboard flash/firmware location for different data like favorites, properties, program type - open
   New: linkageSegmentTable_t* linkageSegmentTable;//Table of linkage segments - open
   
+  Changed: ensembleArena sized by DAB_MAX_SERVICES, DAB_MAX_ARENA_COMPONENTS and DAB_MAX_LONG_SERVICE_IDS, label pool only with DAB_LABEL_POOL - done
+  Changed: measure RAM of static tables with avr-size - open
+  Changed: FLASH_LOAD verifies CRC32 of image in flash once per image, verifiedCrc32Firmware caches result - done
+  Changed: BOOT_HOST_LOAD is default until FLASH_LOAD is confirmed on hardware, bootFirmwareDab() reloads with host relay if BOOT fails - done
+  Changed: hostLoad() waits for CTS of each package, loadFirmware() stops on ERR instead of booting an incomplete image - done
+  New: bandscan records RSSI, SNR, CNR, FIC quality and fastDect, indexListHeader is ranked by qualityWeights, first service on best index, list on heap unless DAB_FIXED_INDEX_LIST - done
+  New: scan, seek and start of first service as scanJob state machine, pollScan() in loop, cancelScan() - done
+  Changed: cancelScan() does not wait for pending tune, service directory fill runs in scanJob - done
+  Changed: frequencyTableHeader caches table of device in fixed array, read in chunks only after writeFrequencyTable() or POWER_UP - done
+  Changed: frequencyTableHeader caches only the number of frequencies, frequencies are read in chunks for print, saves 192 Bytes for label pool - done
+  Changed: tuneIndex() waits for STCINT on INTB with timeout instead of fixed 600ms, STC is cleared with DAB_DIGRAD_STATUS - done
+  Changed: scanIndices() in two phases, fast detect with short acquisition on all indices, full tune only on candidates - done
+  New: service directory of all parsed ensembles in flash after favorites - done
+  Changed: service directory keyed by serviceId and componentId, sorted RAM index of hashes, compacted into second sector when full - done
+  Changed: writeDirectoryService() compares stored slot on match of hash and check before the write is skipped - done
+  New: analyzeCif() maps sub-channels of ensemble in CIF with free CUs and overlaps, cifMap is read again only for other ensemble id or version - done
+  New: handleReconfiguration() diffs service list and keeps or moves actual service - done
+  New: snapshot of last ensemble in flash, restored at boot and checked when service list is available - done
+  Changed: snapshot only of playing ensemble, not of directory fill, its index is tuned at boot - done
+  Changed: hardware access only in writeCommand(), writeCommandArgument(), readFlash(), writeFlash(), eraseFlash(), readInterrupt(), reset() and getFreeRam() - done
+  New: host build with simulated tuner and flash behind these functions - done, host/Makefile
+  Test: readReply() polls and sleeps per command against mocked ComDriverSpi, needs host build - done, host/hostBenchmark.cpp
+  Changed: no fixed waits before readReply(), INT_CTL_ENABLE only with CTSIEN and ERR_CMDIEN, readReply() polls on edge of INTB - done
+  Changed: index list on heap is allocated once per scan with MAX_VALID_INDICES and trimmed after, insertIndex() does not realloc - done
+  Changed: INTB signals only STCINT while tuning, waitSeekTuneComplete() and pollScanTune() read status on its edge - done
+  Test: CRC32 throughput benchmark, needs host build, time on target with device menu 'w' - done, host/hostBenchmark.cpp
+  Test: findService() lookup benchmark with 32 services, needs host build - done, host/benchmark32 with DAB_MAX_SERVICES=32
+  Test: sizeof report of ensembleArena against old serviceList_t, needs host build, sizes on target with dabPrintEnsembleArena() - done, host/hostBenchmark.cpp
+  New: service label, PTY and charset from service list, labels in fixed pool with DAB_LABEL_POOL - done
+  Changed: label pool of DAB_LABEL_POOL_SIZE Bytes by default, printServiceLabel() reads service information only for labels not in pool - done
+  Changed: searchService() uses binary search in sorted index, next/previous in order of serviceId - done
+  Changed: updateEnsemble() parses service list only if ensemble id or list version changed - done
+  Changed: services and components of ensemble in fixed ensembleArena instead of new[]/delete[] - done
+  Changed: ensembleArena as struct of arrays with 16 bit SIds and components by offset - done
+  Changed: getEnsemble() reads service list once in windows of 0x100 Bytes and parses across windows - done
+  Changed: readReply() waits for CTS on INTB, polls as fallback and has a timeout per command - done
+  New: property value lists are a write through shadow, readPropertyValueShadow() reads hot properties without SPI - done
   Changed: use delayMicroseconds instead of delay - done
   Changed: use parameters per reference& in functions to save memory - done
   Changed: printSerial functions get struct parameters per reference to save memory - done
@@ -85,6 +132,9 @@ enum pins_t
 //Max numbers of retry when chip is busy
 enum MAX_RETRY {MAX_RETRY = 10};
 
+//Max number of properties read with one GET_PROPERTY
+enum MAX_PROPERTY_COUNT {MAX_PROPERTY_COUNT = 8};
+
 //Device specific delay times
 enum durationsDevice_t
 {
@@ -99,8 +149,57 @@ enum durationsDevice_t
   DURATION_LOAD_INIT    = 4000,//4ms see flowchart; ?ms see timing
   DURATION_BOOT         = 10000,//350ms = 30 * 10000 us in loop, Boot time 63ms at analog FM, 198ms at DAB
   DURATION_PROPERTY     = 10000,//write / read PropertyValue
+  DURATION_POLL_INTERRUPT = 20,//20us poll interval of INTB while waiting for CTS
+  DURATION_POLL_REPLY   = 1000,//1ms CTS polls with RD_REPLY if INTB is not asserted see timing
+  TIMEOUT_REPLY         = 30000,//30ms = MAX_RETRY * DURATION_REPLY default timeout budget per command
+  TIMEOUT_FLASH_LOAD    = 2000000UL,//2s FLASH_LOAD of 521kB firmware over secondary SPI bus
+  TIMEOUT_BOOT          = 600000UL,//600ms until PUP_STATE application running after BOOT
+};
+
+//How the firmware image gets from flash memory into the device
+enum bootMode_t
+{
+  BOOT_HOST_LOAD  = 0,//Host reads flash memory and relays packages with HOST_LOAD
+  BOOT_FLASH_LOAD = 1,//Device reads flash memory on secondary SPI bus with FLASH_LOAD (AN851)
+};
+
+//Sizes of firmware load
+enum loadSizes_t
+{
+  FLASH_PAGE_SIZE       = 0x100, //Flash memory page, readData() works pagewise
+  MAX_LOAD_PACKAGE_SIZE = 0x1000,//Max package size of HOST_LOAD
+  MIN_LOAD_PACKAGE_SIZE = 0x40,  //Min package size of HOST_LOAD if free RAM is below one flash page
+  RAM_RESERVE_LOAD      = 0x100, //RAM kept free for stack while loading
+};
+
+//Statistics of last firmware load
+struct loadStatistics_t
+{
+  unsigned long duration;    //Duration in ms
+  unsigned long throughput;  //Bytes per second
+  unsigned short packageSize;//Bytes per HOST_LOAD package, 0 with FLASH_LOAD
+};
+
+//Device was running DAB firmware at start of host, set by deviceBegin()
+extern bool warmStart;
+
+//Boot mode, BOOT_HOST_LOAD works on every board, falls back to BOOT_HOST_LOAD if FLASH_LOAD fails or does not boot
+extern unsigned char bootMode;
+//CRC32 of last image verified for FLASH_LOAD, 0 if none
+extern unsigned long verifiedCrc32Firmware;
+//Statistics of last firmware load
+extern loadStatistics_t loadStatistics;
+
+//Statistics of last readReply() to measure the wait time of commands
+struct replyStatistics_t
+{
+  unsigned char polls;    //Number of RD_REPLY transactions until CTS
+  unsigned char interrupt;//CTS was signaled by INTB
+  unsigned long duration; //Wait time in us until CTS or timeout
 };
 
+extern replyStatistics_t replyStatistics;
+
 //Status register 22 Bits, 3 Bytes
 struct statusRegister_t
 {
@@ -170,23 +269,54 @@ extern unsigned short propertyValueListDevice[NUM_PROPERTIES_DEVICE][2];
 //https://stackoverflow.com/questions/3716595/returning-multidimensional-array-from-function
 //unsigned short (*readPropertyValueList())[2];//reads the values from device if given the right id
 unsigned short (*readPropertyValueList(unsigned short propertyValueList[][2], unsigned char numberProperties))[2];//reads the values from device if given the right id
+//What is known about the property values of the device before writing a list
+enum propertyState_t
+{
+  PROPERTIES_WRITE_ALL = 0,//unknown, write all values
+  PROPERTIES_DEFAULT   = 1,//device just booted, skip values equal to default
+  PROPERTIES_READ      = 2,//read values of device first, skip values already set
+};
+
+//Statistics of last writePropertyValueList()
+struct propertyStatistics_t
+{
+  unsigned char written; //SET_PROPERTY commands sent
+  unsigned char skipped; //values already set
+  unsigned long duration;//Duration in ms
+};
+
+extern propertyStatistics_t propertyStatistics;
+
 //writes 2 dimensional property value list with numberProperties to device
-void writePropertyValueList(unsigned short propertyValueList[][2], unsigned char numberProperties);
+void writePropertyValueList(unsigned short propertyValueList[][2], unsigned char numberProperties, unsigned char propertyState = PROPERTIES_WRITE_ALL);
+//Number of contiguous ids in list starting at first, max MAX_PROPERTY_COUNT
+unsigned char countContiguousProperties(unsigned short propertyValueList[][2], unsigned char numberProperties, unsigned char first);
+//Default value of property after BOOT, false if unknown
+bool readPropertyDefault(unsigned short id, unsigned short& value);
+
+//Property value lists of device and DAB are a write through shadow of the device
+extern bool propertyShadowValid;
+//Pointer to value of id in property value lists of device and DAB, nullptr if not in lists
+unsigned short* findPropertyShadow(unsigned short id);
+//Value of property from shadow without SPI, reads device if not in shadow
+unsigned short readPropertyValueShadow(unsigned short id);
+//Read property value lists from device into shadow
+void syncPropertyShadow();
 
 
 //Device functions
-//0x00 RD_REPLY Read answer of device
-bool readReply(unsigned char reply[], unsigned long len);
+//0x00 RD_REPLY Read answer of device, waits for CTS on INTB or polls until timeout in us
+bool readReply(unsigned char reply[], unsigned long len, unsigned long timeout = TIMEOUT_REPLY);
 //0x01 POWER_UP Power-up the device and set system settings
 void powerUp(powerUpArguments_t powerUpArguments);
-//0x04 HOST_LOAD Loads an image from HOST over command interface
-void hostLoad(unsigned char package[], unsigned short len);
+//0x04 HOST_LOAD Loads an image from HOST over command interface, true if package was accepted
+bool hostLoad(unsigned char package[], unsigned short len);
 //0x05 FLASH_LOAD Loads an image from external FLASH over secondary SPI bus
 void flashLoad(unsigned long address, unsigned char subCommand = 0);
 //0x06 LOAD_INIT Prepares the bootloader to receive a new image
 void loadInit();
-//0x07 BOOT Boots the image currently loaded in RAM
-void boot();
+//0x07 BOOT Boots the image currently loaded in RAM, true if application is running
+bool boot();
 //0x08 GET_PART_INFO Get Device Part Info
 void readPartInfo(partInfo_t& partInfo);
 //0x09 GET_SYS_STATE reports basic system state information such as which mode is active; FM, DAB, etc.
@@ -203,6 +333,8 @@ void readFirmwareInformation(firmwareInformation_t& firmwareInformation);
 void writePropertyValue(unsigned short id, unsigned short value);
 //0x14 GET_PROPERTY Retrieve the value of a property
 unsigned short readPropertyValue(unsigned short id);
+//0x14 GET_PROPERTY Retrieve the values of count properties with contiguous ids starting at id
+void readPropertyValues(unsigned short id, unsigned short values[], unsigned char count);
 //0x15 WRITE_STORAGE Writes data to the on board storage area at a specified offset
 void writeStorage(unsigned char data[], unsigned char len, unsigned short offset);
 //0x16 READ_STORAGE Reads data from the on board storage area from a specified offset
@@ -220,81 +352,50 @@ void writeCommand(unsigned char cmd[], unsigned long lenCmd);
 
 //Run setup functions before firmware
 void deviceBegin();
+//Check if device runs DAB firmware of expected revision, firmware load can be skipped
+bool probeWarmStart();
 //Read status register
 void readStatusRegister(statusRegister_t& statusRegister);
+//Interrupt of device asserted (INTB active low)
+bool readInterrupt();
 //Initalize pins
 void initalize();
 //Reset
 void reset(unsigned char resetPin = PIN_DEVICE_RESET);
 //Power Down
 void powerDown(bool enable, unsigned char resetPin = PIN_DEVICE_RESET);
-//Load Firmware from flash memory to device
-void loadFirmware(unsigned long addressFirmware, unsigned long sizeFirmware);
+//Load Firmware from flash memory to device, false if crc32Firmware != 0 and CRC32 of image does not match
+bool loadFirmware(unsigned long addressFirmware, unsigned long sizeFirmware, unsigned long crc32Firmware = 0);
+//Device loads firmware from flash memory itself, true if successful
+bool loadFirmwareFlash(unsigned long addressFirmware);
+//Load and boot DAB firmware, FLASH_LOAD falls back to host relay if device does not boot
+bool bootFirmwareDab();
+//Load firmware image with bootMode, host relay as fallback, false if CRC32 of image does not match
+bool loadFirmwareImage(unsigned long addressFirmware, unsigned long sizeFirmware, unsigned long crc32Firmware = 0);
+//Verify CRC32 of firmware image in flash memory without loading device
+bool verifyFirmware(unsigned long addressFirmware, unsigned long sizeFirmware, unsigned long crc32Firmware);
+//Continue CRC32 with next chunk of data, start with crc32 = 0
+unsigned long updateCrc32(unsigned long crc32, const unsigned char data[], unsigned short len);
+//Size of HOST_LOAD package from free RAM, 0 if RAM_RESERVE_LOAD can not be kept
+unsigned short getLoadPackageSize();
+//Get free RAM
+unsigned short getFreeRam();
+//Read data from flash memory, only access of driver to flash memory
+void readFlash(unsigned long address, unsigned char data[], unsigned short len);
+//Write data to flash memory within one page
+void writeFlash(unsigned long address, unsigned char data[], unsigned short len);
+//Erase sector of flash memory
+void eraseFlash(unsigned long address);
 
 
 //DAB data types
 
-//Component list type 4 Byte
-struct componentList_t
-{
-  //Component ID
-  unsigned short componentId;
-  //unsigned char tmId:        2;//Transmission mode 0...3
-  //unsigned char reserved1:   8;
-  //unsigned char subChannelId:6;
-  //unsigned char fidcId:      6;
-  //unsigned char dgFlag:      1;//data service is transmitted in data groups
-  //unsigned char reserved2:   1;
-  //unsigned char scId:        12;
-
-  //Component Info
-  unsigned char secondaryFlag:          1;//primary (0) or a secondary (1) component of a given service
-  unsigned char conditionalAccessFlag:  1;//Conditional access control
-  unsigned char serviceType:            6;//Audio Service Component Type
-
-  //Valid Flags
-  //unsigned char reserved3:            7;
-  unsigned char validFlag:              1;
-};
-
-//Servicelist type with information about number of components and type and pointer to component list 5+2 = 7 Byte
-struct serviceList_t
-{
-  unsigned long serviceId;
-
-  //dataFlag == 0
-  //unsigned short serviceReference:      12;
-  //unsigned char countryId:              4;
-  //unsigned short reserved0              16;
-
-  //Service Info 1
-  //unsigned char reserved:             1;
-  //unsigned char serviceLinkingFlag:   1;
-  //unsigned char programType:          5;
-  unsigned char dataFlag:               1;//to find audio service
-
-  //Service Info 2
-  //unsigned char localFlag:            1;
-  //unsigned char conditionalAccess:    3;//0 = unscrambled, 1 = NR-MSK, 2 Eurocrypt EN 50094
-  unsigned char numComponents:          4;//Number of components in service (M <= 15)
-
-  //Service Info 3
-  //unsigned char reservedServiceInfo3: 4;
-  //unsigned char characterSet:         4;
-
-  //The name of this service
-  //char serviceLabel[17];
-
-  componentList_t* componentList;  //Pointer to component list
-};
-
-//Ensemble header type with information about listsize, version and num of services
-//and pointer to first servicelist element 9 = 7+2 Byte
-//Ensemble -> ServiceList > ComponentList
+//Ensemble header type with information about listsize, version and num of services 7 Byte
+//Services and components of ensemble are in ensembleArena
 struct ensembleHeader_t
 {
-  unsigned char actualService;//number in serviceList
-  unsigned char actualComponent;//number in componentList
+  unsigned char actualService;//number in service list
+  unsigned char actualComponent;//number in components of service
 
   unsigned short listSize;//Max = 2694 Bytes, not including List Size
   unsigned short version;
@@ -302,7 +403,6 @@ struct ensembleHeader_t
   //unsigned char reserved1;
   //unsigned char reserved2;
   //unsigned char reserved3;
-  serviceList_t* serviceList;
 };
 
 //Time 8 Bytes
@@ -497,44 +597,326 @@ struct frequencyInformationTableHeader_t
   frequencyInformationTable_t* frequencyInformationTable;
 };
 
+
+//Sources of INTB, INT_CTL_ENABLE
+enum interruptSources_t
+{
+  INT_SOURCES_REPLY = 1 << 7 | 1 << 6,//CTSIEN and ERR_CMDIEN for readReply()
+  INT_SOURCES_TUNE  = 1,//STCIEN only while tuning, CTS of DAB_TUNE_FREQ would hold INTB asserted
+};
+
+//DAB specific delay times
+enum durationsDab_t
+{
+  //in mikroseconds
+  TIMEOUT_START_SERVICE         = 100000,//100ms budget until CTS of START/STOP_DIGITAL_SERVICE, was a fixed wait
+  DURATION_TUNE                 = 10000,//Seek Tune Index 600ms, not used since STCINT
+  DURATION_15000_MIKROS         = 15000,
+  DURATION_SNAPSHOT_CHECK      = 500000,//Check restored ensemble snapshot with device
+  DURATION_RECONFIG_CHECK      = 1000000,//Check events for reconfiguration of ensemble
+  DURATION_STC_POLL            = 5000,//Poll of seek tune complete if edge of INTB is missed
+  DURATION_SERVICE_LIST_POLL   = 300000,//Poll of service list available in scanJob
+};
+
+//Build configuration of static RAM, set with compiler flags (-D) or here
+//Defaults fit UNO (2 KB), larger boards can use ETSI limits
+#ifndef DAB_MAX_SERVICES
+#define DAB_MAX_SERVICES 20 //Services in ensembleArena, to ETSI standard<=32
+#endif
+#ifndef DAB_MAX_ARENA_COMPONENTS
+#define DAB_MAX_ARENA_COMPONENTS 32 //Components of all services in ensembleArena
+#endif
+#ifndef DAB_MAX_LONG_SERVICE_IDS
+#define DAB_MAX_LONG_SERVICE_IDS 4 //32 bit SIds of data services
+#endif
+//Service labels in ensembleArena (DAB_LABEL_POOL_SIZE + DAB_MAX_SERVICES + 1 Bytes), max 254
+//Labels that do not fit and all labels with size 0 are read with readServiceInformation()
+#ifndef DAB_LABEL_POOL_SIZE
+#define DAB_LABEL_POOL_SIZE 128
+#endif
+#if DAB_LABEL_POOL_SIZE > 0
+#define DAB_LABEL_POOL
+#endif
+#ifndef DAB_DIRECTORY_KEYS
+#define DAB_DIRECTORY_KEYS 48 //Valid entries of service directory in RAM index, 3 Bytes each, max 126
+#endif
+//Valid indices of bandscan in static table (1 + 13 * MAX_VALID_INDICES Bytes), without table they are on heap after a scan
+//#define DAB_FIXED_INDEX_LIST
+
+enum constantsDab_t
+{
+  MAX_INDEX = 48,//Maximal number of indices in table
+  //Very memory intensive for Uno !
+  //To use about 250 Bytes of RAM with defaults
+  MAX_NUMBER_SERVICES   = DAB_MAX_SERVICES,
+  MAX_NUMBER_COMPONENTS = 4, //per service, to ETSI standard<=15
+  MAX_ARENA_COMPONENTS  = DAB_MAX_ARENA_COMPONENTS,
+  MAX_SERVICE_LIST_SIZE = 2694,//Max size of digital service list
+  LABEL_POOL_SIZE       = DAB_LABEL_POOL_SIZE, //Bytes for service labels without trailing spaces
+  NO_LABEL              = 0xff,//Service label not in pool
+  MAX_LONG_SERVICE_IDS  = DAB_MAX_LONG_SERVICE_IDS,//32 bit SIds of data services, other SIds are stored with 16 bit
+  LONG_SERVICE_ID       = 0x80,//serviceInfo flag, serviceIds holds slot in longServiceIds
+  CIF_SIZE_CU           = 864, //Capacity units of Common Interleaved Frame
+  MAX_NUMBER_SUBCHANNELS = 16, //Sub-channels in CIF map, to ETSI standard<=64
+  SERVICE_LIST_WINDOW   = 0x100,//Bytes per READ_OFFSET of service list, modulo 4
+  FAST_SCAN_ACQ_TIME    = 100, //DAB_VALID_ACQ_TIME in ms during fast detect phase of scan
+  FAST_SCAN_SYNC_TIME   = 100, //DAB_VALID_SYNC_TIME in ms during fast detect phase of scan
+  FAST_SCAN_TIMEOUT     = 1000,//Max ms to seek tune complete in fast detect phase
+  TIMEOUT_TUNE          = 3000,//Max ms to seek tune complete, 10 * 300ms of previous polling
+  TIMEOUT_SERVICE_LIST  = 10000,//Max ms to wait for service list after tune
+  FAST_DETECT_THRESHOLD = 4,   //fastDect greater than threshold is DAB signal
+  FREQ_TABLE_CHUNK      = 16,  //Frequencies per READ_OFFSET of frequency table
+  MAX_VALID_INDICES     = 12   //Valid indices of bandscan in indexListHeader, worst is replaced if full
+};
+
+//Cache of number of frequencies of device, invalid after writeFrequencyTable() and POWER_UP
+//Frequencies are read with readFrequencies() when needed, a table would take 4 Bytes per index
 struct frequencyTableHeader_t
 {
     uint8_t number;
-    uint32_t* table;
+    uint8_t valid;
 };
 
-//valid indices after bandscan
+//valid indices after bandscan with signal quality 13 Bytes
 struct indexList_t
 {
       uint8_t index;//Max 47
       uint8_t valid;
       uint32_t frequency;
+      int8_t rssi;//dBuV
+      int8_t snr;//dB
+      uint8_t cnr;//dB 0-54
+      uint8_t ficQuality;//0-100
+      uint8_t fastDect;
+      int16_t score;//quality of qualityWeights
 };
 
+//Valid indices sorted by score, best first, on heap or in preallocated table with DAB_FIXED_INDEX_LIST
 struct indexListHeader_t
 {
     uint8_t size;
+#ifdef DAB_FIXED_INDEX_LIST
+    indexList_t indexList[MAX_VALID_INDICES];
+#else
+    uint8_t capacity;//allocated entries, MAX_VALID_INDICES while scanning, trimmed to size after
     indexList_t* indexList;
+#endif
 };
 
+//Weights of signal quality in score of indexList_t, score = sum of weight * metric
+struct qualityWeights_t
+{
+  int8_t rssi;
+  int8_t snr;
+  int8_t cnr;
+  int8_t ficQuality;
+  int8_t fastDect;
+};
 
-//DAB specific delay times
-enum durationsDab_t
+//Fixed block for services, components and labels of ensemble, about 580 Bytes on UNO
+//Struct of arrays without pointers, services find their components by offset
+//Service list from device:
+//Service ID 4 Byte, Service Info 1..3, Reserved
+//  Component ID 2 Byte, Component Info, Valid Flags
+struct ensembleArena_t
 {
-  //in mikroseconds
-  DURATION_STOP_START_SERVICE   = 10000,
-  DURATION_TUNE                 = 10000,//Seek Tune Index 600ms
-  DURATION_15000_MIKROS         = 15000,
-  DURATION_10000_MIKRO         = 10000,//Get ensemble info
+  //Services in order of service list
+  unsigned short serviceIds[MAX_NUMBER_SERVICES];//16 bit SId or slot in longServiceIds
+  unsigned char serviceInfo[MAX_NUMBER_SERVICES];//[7] LONG_SERVICE_ID, [6] linking, [5:1] PTY, [0] data flag
+  unsigned char serviceComponents[MAX_NUMBER_SERVICES];//[7:4] charset, [3:0] number of stored components
+  unsigned char firstComponent[MAX_NUMBER_SERVICES];//offset of first component in componentIds
+#ifdef DAB_LABEL_POOL
+  unsigned char serviceLabels[MAX_NUMBER_SERVICES];//offset in labels, NO_LABEL if pool was full
+#endif
+  unsigned long longServiceIds[MAX_LONG_SERVICE_IDS];//data services with ECC in SId
+  unsigned char numLongServiceIds;
+
+  //Components of all services
+  unsigned short componentIds[MAX_ARENA_COMPONENTS];
+  unsigned char componentInfo[MAX_ARENA_COMPONENTS];//[7:2] service type, [1] secondary, [0] conditional access
+
+  unsigned char order[MAX_NUMBER_SERVICES];//services sorted by serviceId
+#ifdef DAB_LABEL_POOL
+  char labels[LABEL_POOL_SIZE];//service labels terminated by '\0'
+  unsigned char lenLabels;//used bytes of labels
+#endif
+  unsigned char actualRank;//position of actual service in order
+  unsigned char numComponents;//used components
+  unsigned char maxServices;//high water mark of services
+  unsigned char maxComponents;//high water mark of components
 };
 
-enum constantsDab_t
+//Key of parsed ensemble in ensembleArena
+struct ensembleCache_t
 {
-  MAX_INDEX = 48,//Maximal number of indices in table
-  //Very memory intensive for Uno !
-  //To use about 500 Bytes of RAM
-  MAX_NUMBER_SERVICES   = 20, //to ETSI standard<=32
-  MAX_NUMBER_COMPONENTS = 4  //to ETSI standard<=15
+  unsigned short ensembleId;
+  unsigned short version;//service list version
+  unsigned char index;//tuned index
+  unsigned char serviceType;
+  unsigned char valid:          1;//ensembleArena holds list of key
+  unsigned char checkEnsemble:  1;//tuned, ensemble id has to be checked
+  unsigned char snapshot:       1;//restored from flash, not yet checked with device
+  unsigned short hits;//parses saved
+  unsigned short misses;//parses done
+};
+
+//Sub-channel in CIF map
+struct subchannel_t
+{
+  unsigned short addressCU;//start CU in CIF
+  unsigned short numberCU;
+  unsigned short bitRate;//kbps
+  unsigned char protectionInfo;
+  unsigned char serviceMode;
+  unsigned char components;//components sharing the sub-channel
+};
+
+//Allocation of CIF sorted by start CU, valid for ensemble id and service list version
+struct cifMap_t
+{
+  unsigned short ensembleId;
+  unsigned short version;
+  unsigned char valid:    1;
+  unsigned char size;//sub-channels in map
+  unsigned char dropped;//sub-channels without space in map
+  unsigned char overlaps;//sub-channels overlapping the previous one
+  unsigned short freeCU;
+  unsigned short cuLevel;//decoded CUs of RSQ
+  subchannel_t subchannels[MAX_NUMBER_SUBCHANNELS];
+};
+
+//Difference of service list after reconfiguration
+struct ensembleDiff_t
+{
+  unsigned char added;//services
+  unsigned char removed;//services
+  unsigned char changed;//services with other components, type or label
+  unsigned char serviceKept: 1;//actual service still running
+};
+
+//Last tuneIndex() to measure tune latency per index
+struct tuneStatistics_t
+{
+  unsigned char index;
+  unsigned char complete:  1;//STC before TIMEOUT_TUNE
+  unsigned char interrupt: 1;//STC was signaled by INTB
+  unsigned short latency;//Duration in ms until STC
+};
+
+//Result of last scanIndices()
+struct scanStatistics_t
+{
+  unsigned char indices;//indices of frequency table
+  unsigned char candidates;//fast detect passed
+  unsigned char valid;//full acquisition passed
+  unsigned long durationFast;//Duration in ms of fast detect phase
+  unsigned long durationFull;//Duration in ms of full acquisition phase
+};
+
+//Steps of scanJob, one tune or poll per pollScan()
+enum scanState_t
+{
+  SCAN_IDLE         = 0,
+  SCAN_FAST         = 1,//fast detect phase of band scan on all indices
+  SCAN_FULL         = 2,//full acquisition phase of band scan on candidates
+  SCAN_SEEK         = 3,//seek up or down to next valid index
+  SCAN_SERVICE_LIST = 4,//wait for service list and start first service
+  SCAN_DIRECTORY    = 5,//tune valid index of band scan for service directory
+  SCAN_DIRECTORY_LIST = 6 //wait for service list of index and store it in service directory
+};
+
+//Events of scanJob for progress callback
+enum scanEvent_t
+{
+  SCAN_EVENT_INDEX     = 0,//index without DAB
+  SCAN_EVENT_CANDIDATE = 1,//fast detect passed
+  SCAN_EVENT_VALID     = 2,//valid index, appended to index list at band scan
+  SCAN_EVENT_DONE      = 3,//band scan or seek done
+  SCAN_EVENT_SERVICE   = 4,//first service started or no service list
+  SCAN_EVENT_CANCEL    = 5,
+  SCAN_EVENT_DIRECTORY = 6 //services of index stored in service directory
+};
+
+struct scanJob_t;
+//Progress callback of scanJob, scanJob.index is the actual index
+typedef void (*scanProgress_t)(const scanJob_t& scanJob, unsigned char event);
+
+//Scan and seek without blocking loop(), driven by pollScan()
+struct scanJob_t
+{
+  unsigned char state;//scanState_t
+  unsigned char tuning:       1;//DAB_TUNE_FREQ sent, waiting for STC
+  unsigned char up:           1;//direction of seek
+  unsigned char startService: 1;//start first service after band scan or seek
+  unsigned char serviceType:  1;//0 = audio, 1 = data
+  unsigned char cancelled:    1;//pending tune belongs to cancelled scan, STCINT is cleared by pollScan()
+  unsigned char directory:    1;//fill service directory after band scan
+  unsigned char index;//actual index
+  unsigned char entry;//entry of index list in service directory fill
+  unsigned char indexStart;//seek ends here
+  unsigned char numberIndices;
+  unsigned char found;//valid indices, 1 if service was started
+  unsigned char candidates[(MAX_INDEX + 7) / 8];//fast detect passed, one bit per index
+  unsigned short acqTime;//DAB_VALID_ACQ_TIME restored after fast detect phase
+  unsigned short syncTime;//DAB_VALID_SYNC_TIME restored after fast detect phase
+  unsigned long start;//ms of phase
+  unsigned long startTune;//ms of DAB_TUNE_FREQ
+  unsigned long lastPoll;//us of last status or event poll
+  indexListHeader_t* indexListHeader;//valid indices of band scan
+  scanProgress_t progress;//nullptr without callback
+};
+
+//Service directory in flash, entries of 32 Bytes are appended, never cross a page
+//Slot 0 is header [0] DIRECTORY_HEADER, [1] sequence, valid entries are compacted into other sector if full
+//[0] state, [1] index, [2:3] ensembleId, [4:7] serviceId, [8:9] componentId, [10] PTY, [11] reserved, [12:27] label
+enum serviceDirectoryConstants_t
+{
+  DIRECTORY_SIZE        = 0x1000,//one sector
+  DIRECTORY_ENTRY_SIZE  = 32,
+  DIRECTORY_ENTRIES     = DIRECTORY_SIZE / DIRECTORY_ENTRY_SIZE,//slots including header
+  DIRECTORY_EMPTY       = 0xff,//erased flash
+  DIRECTORY_VALID       = 0xa5,
+  DIRECTORY_DELETED     = 0x00,//replaced by newer entry, written without erase
+  DIRECTORY_HEADER      = 0x5a,//sector is formatted
+  MAX_DIRECTORY_KEYS    = DAB_DIRECTORY_KEYS,
+  DIRECTORY_ANY_COMPONENT = 0xffff//first stored component of service
+};
+
+//Ensemble snapshot in flash, header of 16 Bytes followed by ensembleArena
+//[0] state, [1] index, [2:3] ensembleId, [4:5] version, [6] numServices, [7] serviceType, [8:9] size of arena, [12:15] CRC32 of arena
+enum ensembleSnapshotConstants_t
+{
+  SNAPSHOT_HEADER_SIZE  = 16,
+  SNAPSHOT_VALID        = 0xa5
+};
+
+//Entry of service directory
+struct directoryEntry_t
+{
+  unsigned long serviceId;
+  unsigned short componentId;
+  unsigned short ensembleId;
+  unsigned char index;
+  unsigned char programType;
+  char label[17];
+};
+
+//Valid entry of service directory in RAM index
+struct directoryKey_t
+{
+  unsigned char hash;//of serviceId, index is sorted by hash
+  unsigned char check;//of all fields, unchanged entries are found without reading flash
+  unsigned char slot;//in active sector
+};
+
+//RAM part of service directory, entries stay in flash
+struct serviceDirectory_t
+{
+  unsigned char count;//used slots of active sector, next entry is appended at count, 0 if not formatted
+  unsigned char sector;//active sector, 0 ADDRESS_SERVICE_DIRECTORY, 1 ADDRESS_SERVICE_DIRECTORY_COPY
+  unsigned char sequence;//of active sector, compacted copy gets sequence + 1
+  unsigned char size;//valid entries in keys
+  directoryKey_t keys[MAX_DIRECTORY_KEYS];
 };
 
 //Callback function pointer
@@ -555,10 +937,38 @@ extern uint8_t index;
 //Property value list DAB
 extern unsigned short propertyValueListDab[NUM_PROPERTIES_DAB][2];
 
-//Ensemble - dynamic allocation
+//Ensemble - services and components in ensembleArena
 extern ensembleHeader_t ensembleHeader;
 
-//Frequency table - dynamic allocation
+//Services and components of ensemble in one fixed block
+extern ensembleArena_t ensembleArena;
+
+//Key of parsed ensemble
+extern ensembleCache_t ensembleCache;
+
+//Service directory in flash
+extern serviceDirectory_t serviceDirectory;
+
+//Difference of service list after last reconfiguration
+extern ensembleDiff_t ensembleDiff;
+
+//Allocation of CIF of parsed ensemble
+extern cifMap_t cifMap;
+
+
+//Last tuneIndex()
+extern tuneStatistics_t tuneStatistics;
+
+//Result of last scanIndices()
+extern scanStatistics_t scanStatistics;
+
+//Running scan or seek
+extern scanJob_t scanJob;
+
+//Weights of score of scanned indices
+extern qualityWeights_t qualityWeights;
+
+//Frequency table - cache of device without heap
 extern frequencyTableHeader_t frequencyTableHeader;
 
 //valid indices after bandscan
@@ -570,10 +980,24 @@ extern indexListHeader_t indexListHeader;
 void dabBegin();
 //Get ensemble header
 void getEnsembleHeader(ensembleHeader_t& ensembleHeader, unsigned char serviceType = 0);
-//Get ensemble an fill serviceList and componentList
+//Decode list header of GET_DIGITAL_SERVICE_LIST reply, buf[0...3] is status
+void parseEnsembleHeader(ensembleHeader_t& ensembleHeader, const unsigned char buf[]);
+//Get ensemble an fill services and components of ensembleArena
 void getEnsemble(ensembleHeader_t& ensembleHeader, unsigned char serviceType = 0);
-//Free memory from Ensemble List Data Structure
-void freeMemoryFromEnsembleList(ensembleHeader_t &ensembleHeader);
+//Parse ensemble only if ensemble id or service list version changed, true if services are available
+bool updateEnsemble(ensembleHeader_t& ensembleHeader, unsigned char serviceType = 0);
+//Services of ensembleArena by number in service list
+unsigned long getServiceId(unsigned char service);
+unsigned char getDataFlag(unsigned char service);
+unsigned char getProgramType(unsigned char service);
+unsigned char getCharacterSet(unsigned char service);
+unsigned char getNumComponents(unsigned char service);
+unsigned short getComponentId(unsigned char service, unsigned char component);
+unsigned char getComponentType(unsigned char service, unsigned char component);
+//Service label from ensemble, nullptr if not in pool or built without DAB_LABEL_POOL
+const char* getServiceLabel(unsigned char service);
+//Clear Ensemble List Data Structure, arena is reused without heap
+void clearEnsembleList(ensembleHeader_t &ensembleHeader);
 
 //Start next service in ensemble
 void nextService(unsigned long &serviceId, unsigned long &componentId);
@@ -581,23 +1005,114 @@ void nextService(unsigned long &serviceId, unsigned long &componentId);
 void previousService(unsigned long &serviceId, unsigned long &componentId);
 //Search _serviceId and _componentId in ensemble and save in actualService, if found returns true
 bool searchService(unsigned long &serviceId, unsigned long &componentId);
-//Start first serviceType (0 = audio, 1 = data) in ensemble
+//Sort services of arena by serviceId, stable order for next/previous
+void buildServiceIndex(ensembleHeader_t &ensembleHeader);
+//Binary search of serviceId in sorted index, rank is position in index
+bool findService(ensembleHeader_t &ensembleHeader, unsigned long serviceId, unsigned char &rank);
+//Start first serviceType (0 = audio, 1 = data) in ensemble, service list has to be available
 void startFirstService(unsigned long &serviceId, unsigned long &componentId, unsigned char serviceType = 0);
 
-//Scan all indices of frequency table
+//Scan all indices of frequency table, fast detect first, then full acquisition on candidates, blocks until done
 void scanIndices(indexListHeader_t& indexListHeader);
+//Start band scan in scanJob, valid indices are appended to indexListHeader while scanning
+void beginScan(indexListHeader_t& indexListHeader, scanProgress_t progress = nullptr, bool startService = false);
+//Start seek up/down to next valid index in scanJob
+void beginSeek(bool up = true, scanProgress_t progress = nullptr);
+//Wait for service list in scanJob and start first serviceType
+void beginFirstService(unsigned char serviceType = 0, scanProgress_t progress = nullptr);
+//One step of scanJob, call in loop, true while scan is running
+bool pollScan();
+//Start filling service directory with service lists of valid indices in scanJob, band scan first if list is empty
+void beginDirectoryScan(indexListHeader_t& indexListHeader, scanProgress_t progress = nullptr);
+//Stop scanJob without waiting, STCINT of pending tune is cleared by pollScan(), found indices are kept
+void cancelScan();
+//Score of signal quality with qualityWeights
+int16_t scoreIndex(const indexList_t& indexList);
+//Insert valid index by score, replaces worst index if table is full, false if worse than all
+bool insertIndex(indexListHeader_t& indexListHeader, const indexList_t& indexList);
+//Score all indices again and sort, best first, after qualityWeights changed
+void rankIndexList(indexListHeader_t& indexListHeader);
+//Frees unused entries of table on heap after scan
+void trimIndexList(indexListHeader_t& indexListHeader);
+//Steps of scanJob
+void scanProgress(unsigned char event);
+unsigned char nextSeekIndex(unsigned char index);
+unsigned char nextCandidate(unsigned char index);
+void startScanTune();
+bool pollScanTune(rsqInformation_t& rsqInformation);
+void finishScan();
+void beginDirectoryFill();
 
 //Tune up = true/down = false
 void tune(unsigned char& index, bool up = true);
 
+//Service directory
+//Find active sector of service directory in flash and build RAM index of valid entries
+void beginServiceDirectory();
+//Address of slot in sector of service directory
+unsigned long getDirectoryAddress(unsigned char sector, unsigned char slot);
+//Read entry of active sector of service directory, true if valid
+bool readDirectoryEntry(unsigned char slot, directoryEntry_t& entry);
+//Key of serviceId in RAM index
+unsigned char hashDirectoryService(unsigned long serviceId);
+//Checksum of all fields of entry, unchanged entries are found without reading flash
+unsigned char checkDirectoryEntry(const directoryEntry_t& entry);
+//First key with hash in RAM index or position to insert
+unsigned char lowerDirectoryKey(unsigned char hash);
+//Insert key of valid entry sorted by hash, false if index is full
+bool insertDirectoryKey(unsigned char hash, unsigned char check, unsigned char slot);
+//Find key of serviceId and componentId (DIRECTORY_ANY_COMPONENT for first component), size of index if not found
+unsigned char findDirectoryKey(unsigned long serviceId, unsigned short componentId, directoryEntry_t& entry);
+//Find valid entry of serviceId and componentId in service directory
+bool findDirectoryService(unsigned long serviceId, directoryEntry_t& entry, unsigned char& slot, unsigned short componentId = DIRECTORY_ANY_COMPONENT);
+//Erase sector and write header, entries follow from slot 1
+void formatServiceDirectory(unsigned char sector, unsigned char sequence);
+//Copy valid entries into other sector, old sector stays until next compaction
+void compactServiceDirectory();
+//Append entry to service directory if new or changed
+void writeDirectoryService(directoryEntry_t& entry);
+//Store stored components of services of parsed ensemble in service directory
+void storeEnsembleInDirectory(ensembleHeader_t& ensembleHeader, unsigned char index, unsigned short ensembleId);
+//Tune and start serviceId of service directory, first component if componentId is DIRECTORY_ANY_COMPONENT
+bool startDirectoryService(unsigned long id, unsigned short component = DIRECTORY_ANY_COMPONENT);
+//Tune and start next service of service directory after actual service and component
+bool nextDirectoryService();
+//Multiplex capacity
+//Sub-channels of all components of parsed ensemble sorted by start CU, only read again for other ensemble or version
+bool analyzeCif(cifMap_t& cifMap);
+
+//Reconfiguration
+//Checksum of components, type and label of service to find changed services
+unsigned short hashService(unsigned char service);
+//Read service list again, diff with cached list and keep or move actual service, true if actual service is kept
+bool handleReconfiguration();
+//Check events for reconfiguration of ensemble, call in loop
+void checkReconfiguration();
+
+//Ensemble snapshot
+//Write parsed ensemble to flash if it is not stored yet
+void saveEnsembleSnapshot();
+//Index of stored snapshot, index is unchanged if there is no valid snapshot
+bool readEnsembleSnapshotIndex(unsigned char& index);
+//Restore ensemble of tuned index from flash, true if valid
+bool restoreEnsembleSnapshot();
+//Check restored snapshot with service list of device, call in loop
+void checkEnsembleSnapshot();
+
 //0x81 START_DIGITAL_SERVICE Starts an audio or data service
 void startService(const unsigned long& serviceId, const unsigned long& componentId, const unsigned char serviceType = 0);
 //0x82 STOP_DIGITAL_SERVICE Stops an audio or data service
 void stopService(const unsigned long& serviceId, const unsigned long& componentId, const unsigned char serviceType = 0);
 //0x84 GET_DIGITAL_SERVICE_DATA Gets a block of data associated with one of the enabled data components of a digital services
 void readServiceData(serviceData_t& serviceData, unsigned char statusOnly = 1, unsigned char ack = 0);
-//0xB0 Tunes to frequency index
+//0xB0 Tunes to frequency index, waits for STCINT and clears it
 void tuneIndex(unsigned char index, unsigned short varCap = 0, unsigned char injection = 0);
+//0xB0 Sends tune to frequency index without waiting for seek tune complete
+void writeTuneIndex(unsigned char index, unsigned short varCap = 0, unsigned char injection = 0);
+//Waits for STCINT on INTB or polls status, false after timeout in ms
+bool waitSeekTuneComplete(unsigned short timeout);
+//Enables CTS on INTB again and clears STCINT of tune
+void clearSeekTuneComplete(rsqInformation_t& rsqInformation);
 //0xB2 DAB_DIGRAD_STATUS Get status information about the received signal quality
 void readRsqInformation(rsqInformation_t& rsqInformation, unsigned char clearDigradInterrupt = 0, unsigned char rssiAtTune = 0, unsigned char clearStcInterrupt = 0);
 //0xB3 DAB_GET_EVENT_STATUS Gets information about the various events related to the DAB radio
@@ -609,8 +1124,10 @@ void readServiceLinkingInfo(serviceLinkingInformation_t& serviceLinkingInformati
 //0xB8 DAB_SET_FREQ_LIST Set frequency table
 void writeFrequencyTable(const unsigned long frequencyTable[], const unsigned char numFreq);
 
-//0xB9 DAB_GET_FREQ_LIST Get frequency table
+//0xB9 DAB_GET_FREQ_LIST Get number of frequencies, only if cache is not valid
 void readFrequencyTable(frequencyTableHeader_t& frequencyTableHeader);
+//0xB9 DAB_GET_FREQ_LIST Get len frequencies from index first on, max FREQ_TABLE_CHUNK, false if not in table
+bool readFrequencies(uint32_t frequencies[], uint8_t first, uint8_t len);
 
 //0xBB DAB_GET_COMPONENT_INFO Get information about the component application data
 void readComponentInformation(componentInformation_t& componentInformation, unsigned long &serviceId, unsigned long &componentId);
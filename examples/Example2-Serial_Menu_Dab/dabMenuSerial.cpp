@@ -31,6 +31,20 @@ void callSerialMonitorApplication()
   {
     ch =  Serial.read();
   }
+
+  //Scan or seek running, x cancels, only keys without tuning are handled
+  if (pollScan())
+  {
+    if (ch == 'x') cancelScan();
+    if (ch != 'q' && ch != 'f' && ch != 'm' && ch != '+' && ch != '-') ch = ' ';
+  }
+  else
+  {
+    //Ensemble from flash is checked as soon as the service list is available
+    checkEnsembleSnapshot();
+    //Follow reconfiguration of ensemble
+    checkReconfiguration();
+  }
   //Received signal quality
   if (ch == 'q')
   {
@@ -66,18 +80,14 @@ void callSerialMonitorApplication()
   else if (ch == 'd')
   {
     nextService(serviceId, componentId);
-    serviceInformation_t serviceInformation;
-    readServiceInformation(serviceInformation, serviceId);
-    Serial.println(serviceInformation.serviceLabel);
+    printServiceLabel();
   }
 
   //previous service
   else if (ch == 'a')
   {
     previousService(serviceId, componentId);
-    serviceInformation_t serviceInformation;
-    readServiceInformation(serviceInformation, serviceId);
-    Serial.println(serviceInformation.serviceLabel);
+    printServiceLabel();
   }
 
   //Mute and Unmute
@@ -180,8 +190,8 @@ void menuMain(char ch)
     //Starts an audio or data service
     startService(serviceId, componentId);
 
-    //parse ensemble
-    getEnsemble(ensembleHeader);
+    //parse ensemble if service list changed
+    updateEnsemble(ensembleHeader);
 
   }
 
@@ -200,8 +210,8 @@ void menuMain(char ch)
     //Starts an audio or data service
     startService(serviceId, componentId);
 
-    //parse ensemble
-    getEnsemble(ensembleHeader);
+    //parse ensemble if service list changed
+    updateEnsemble(ensembleHeader);
   }
 
   //Start dedicated service in ensemble
@@ -216,8 +226,8 @@ void menuMain(char ch)
     //Starts an audio or data service
     startService(serviceId, componentId);
     
-    //parse ensemble
-    getEnsemble(ensembleHeader);
+    //parse ensemble if service list changed
+    updateEnsemble(ensembleHeader);
   }
 
   //Start dedicated service in ensemble
@@ -235,8 +245,8 @@ void menuMain(char ch)
     //Starts an audio or data service
     startService(serviceId, componentId);
 
-    //parse ensemble
-    getEnsemble(ensembleHeader);
+    //parse ensemble if service list changed
+    updateEnsemble(ensembleHeader);
   }
 
   //Start dedicated service in ensemble
@@ -253,8 +263,22 @@ void menuMain(char ch)
     //Starts an audio or data service
     startService(serviceId, componentId);
 
-    //parse ensemble
-    getEnsemble(ensembleHeader);
+    //parse ensemble if service list changed
+    updateEnsemble(ensembleHeader);
+  }
+
+  //Start next service of service directory, also in other ensembles
+  else if (ch == 'j')
+  {
+    if (nextDirectoryService())
+    {
+      Serial.println(index);
+      printServiceLabel();
+    }
+    else
+    {
+      serialPrintSi468x::printError(4);
+    }
   }
 
   //Start service
@@ -308,8 +332,10 @@ void menuScanEnsemble(char ch)
 
     if (eventInformation.serviceListAvailable == 1)
     {
-      getEnsembleHeader(ensembleHeader);
-      serialPrintSi468x::dabPrintEnsembleHeader(ensembleHeader);
+      //local header, parsed ensemble stays valid
+      ensembleHeader_t header = {0, 0, 0, 0, 0};
+      getEnsembleHeader(header);
+      serialPrintSi468x::dabPrintEnsembleHeader(header);
     }
     else
     {
@@ -328,6 +354,8 @@ void menuScanEnsemble(char ch)
     {
       getEnsemble(ensembleHeader);
       serialPrintSi468x::dabPrintEnsemble(ensembleHeader);
+      serialPrintSi468x::dabPrintEnsembleArena(ensembleArena);
+      serialPrintSi468x::dabPrintEnsembleCache(ensembleCache);
     }
     else
     {
@@ -335,10 +363,17 @@ void menuScanEnsemble(char ch)
     }
   }
 
+  //Update service list after reconfiguration
+  else if (ch == 'u')
+  {
+    handleReconfiguration();
+    serialPrintSi468x::dabPrintEnsembleDiff(ensembleDiff);
+  }
+
   //Start 1st Service
   else if (ch == '0')
   {
-    startFirstService(serviceId, componentId);
+    beginFirstService(0, printScanProgress);
   }
 
   //Check DAB service data
@@ -415,6 +450,7 @@ void menuScanFrequency(char ch)
   {
     tune(index, true);
     Serial.println(index);
+    serialPrintSi468x::dabPrintTuneStatistics(tuneStatistics);
   }
 
   //index down
@@ -422,124 +458,25 @@ void menuScanFrequency(char ch)
   {
     tune(index, false);
     Serial.println(index);
+    serialPrintSi468x::dabPrintTuneStatistics(tuneStatistics);
   }
 
   //Scan Index Up
   else if (ch == '.')
   {
-    //remember start index
-    rsqInformation_t rsqInformation;
-    readRsqInformation(rsqInformation);
-    unsigned char indexStart = rsqInformation.index;
-
-    do
-    {
-      //tune index up
-      tune(index, true);
-
-      //get receive quality
-      readRsqInformation(rsqInformation);
-      Serial.print(F("Index:\t"));
-      Serial.println(rsqInformation.index);
-
-      //DAB found and valid if threshold for dab detected and greater than 4
-      if ((rsqInformation.fastDect > 4) && rsqInformation.valid == 1)
-      {
-        Serial.println(F("Valid index found"));
-        index = rsqInformation.index;
-        Serial.println(index);
-        break;
-      }
-      //around
-      else if (rsqInformation.index == indexStart)
-      {
-        Serial.println(F("Nothing found"));
-        //nothing found
-        index = rsqInformation.index;
-        Serial.println(index);
-        break;
-      }
-    }
-    while (rsqInformation.index != indexStart);
+    beginSeek(true, printScanProgress);
   }
 
   //Scan Index Down
   else if (ch == ',')
   {
-    //remember start index
-    rsqInformation_t rsqInformation;
-    readRsqInformation(rsqInformation);
-    unsigned char indexStart = rsqInformation.index;
-
-    do
-    {
-      //tune index down
-      tune(index, false);
-
-      //get receive quality
-      readRsqInformation(rsqInformation);
-      Serial.print(F("Index:\t"));
-      Serial.println(rsqInformation.index);
-
-      //DAB found and valid if threshold for dab detected and greater than 4
-      if ((rsqInformation.fastDect > 4) && rsqInformation.valid == 1)
-      {
-        Serial.println(F("Valid index found"));
-        index = rsqInformation.index;
-        Serial.println(index);
-        break;
-      }
-      //around
-      else if (rsqInformation.index == indexStart)
-      {
-        Serial.println(F("Nothing found"));
-        //nothing found
-        index = rsqInformation.index;
-        Serial.println(index);
-        break;
-      }
-    }
-    while (rsqInformation.index != indexStart);
+    beginSeek(false, printScanProgress);
   }
 
-  //Bandscan
+  //Bandscan, first service of first valid index is started
   else if (ch == 's')
   {
-    scanIndices(indexListHeader);
-    serialPrintSi468x::dabPrintIndexList(indexListHeader);
-
-    if (indexListHeader.indexList != nullptr)
-    {
-      //Set index to first entry in scanned table
-      index = indexListHeader.indexList[0].index;
-      Serial.println(F("Index: "));
-      Serial.println(index);
-      tuneIndex(index);
-
-
-      eventInformation_t eventInformation;
-      //wait for ensemble list available
-      for (uint8_t i = 0; i < 10; i++)
-      {
-        readEventInformation(eventInformation);
-        delay(1000);
-        Serial.println(F("Wait for Servicelist..."));
-        if (eventInformation.serviceListAvailable == 1) break;
-      }
-
-      if (eventInformation.serviceListAvailable == 1)
-      {
-        //getEnsemble(ensembleHeader);
-        serialPrintSi468x::dabPrintEnsemble(ensembleHeader);
-        //startfirstService
-        startFirstService(serviceId, componentId);
-      }
-      else
-      {
-        serialPrintSi468x::printError(2);
-      }
-    }
-    serialPrintSi468x::printFreeRam(getFreeRam());
+    beginScan(indexListHeader, printScanProgress, true);
   }
 
   //Get Valid Index List
@@ -548,6 +485,19 @@ void menuScanFrequency(char ch)
     serialPrintSi468x::dabPrintIndexList(indexListHeader);
   }
 
+  //Store ensembles of all valid indices in service directory
+  else if (ch == 'S')
+  {
+    //band scan first if no valid indices, runs in loop, directory is printed when done
+    beginDirectoryScan(indexListHeader, printScanProgress);
+  }
+
+  //Print service directory
+  else if (ch == 'g')
+  {
+    serialPrintSi468x::dabPrintServiceDirectory(serviceDirectory);
+  }
+
   //Tune valid index (frequency) up
   else if (ch == '+')
   {
@@ -604,6 +554,13 @@ void menuTechnical(char ch)
     serialPrintSi468x::dabPrintComponentTechnicalInformation(componentTechnicalInformation);
   }
 
+  //Get and print allocation of all sub-channels
+  else if (ch == 'c')
+  {
+    if (analyzeCif(cifMap)) serialPrintSi468x::dabPrintCifMap(cifMap);
+    else serialPrintSi468x::printError(2);
+  }
+
   //Get and print date and time
   else if (ch == '#')
   {
@@ -686,7 +643,7 @@ void menuTechnical(char ch)
     //0 : Switch Open
     //1 : Switch Closed Default
     uint8_t frontEndSwitch = 1;
-    frontEndSwitch = readPropertyValue(DAB_TUNE_FE_CFG);
+    frontEndSwitch = readPropertyValueShadow(DAB_TUNE_FE_CFG);
     if (frontEndSwitch == 1)
     {
       frontEndSwitch = 0;
@@ -777,6 +734,19 @@ void menuDevice(char ch)
     serialPrintSi468x::printPropertyValueList(readPropertyValueList(propertyValueListDevice, NUM_PROPERTIES_DEVICE), NUM_PROPERTIES_DEVICE);
   }
 
+  //Read properties of device into shadow, r is service info of every menu
+  else if (ch == 'o')
+  {
+    syncPropertyShadow();
+    Serial.println(F("Properties synchronized"));
+  }
+
+  //Print wait statistics of last command
+  else if (ch == 'c')
+  {
+    serialPrintSi468x::printReplyStatistics(replyStatistics);
+  }
+
   //power down
   /*
     else if (ch == 'd')
@@ -790,20 +760,53 @@ void menuDevice(char ch)
     }
   */
 
+  //Verify firmware images in flash memory, f is Free RAM of every menu
+  else if (ch == 'w')
+  {
+    unsigned long start = millis();
+    bool valid = verifyFirmware(addrBootloaderPatchFull, sizeBootloaderPatchFull, crc32BootloaderPatchFull);
+    serialPrintSi468x::printVerifyFirmware(nameBootloaderPatchFull, valid, sizeBootloaderPatchFull, millis() - start);
+
+    start = millis();
+    valid = verifyFirmware(addrFirmwareDab, sizeFirmwareDab, crc32FirmwareDab);
+    serialPrintSi468x::printVerifyFirmware(nameFirmwareDab, valid, sizeFirmwareDab, millis() - start);
+
+    //next FLASH_LOAD needs no check
+    if (valid) verifiedCrc32Firmware = crc32FirmwareDab;
+    else verifiedCrc32Firmware = 0;
+  }
+
+  //Toggle boot mode FLASH_LOAD / HOST_LOAD for next boot
+  else if (ch == 'b')
+  {
+    if (bootMode == BOOT_FLASH_LOAD) bootMode = BOOT_HOST_LOAD;
+    else bootMode = BOOT_FLASH_LOAD;
+    serialPrintSi468x::printBootInformation(bootMode, loadStatistics);
+  }
+
   //boot
   else if (ch == '6')
   {
     initalize();
     reset();
     powerUp(powerUpArguments);
-    loadFirmware(addrBootloaderPatchFull, sizeBootloaderPatchFull); //FullPatch
-    loadFirmware(addrFirmwareDab, sizeFirmwareDab);//DAB Firmware
-    boot();
+    //FullPatch
+    if (loadFirmware(addrBootloaderPatchFull, sizeBootloaderPatchFull, crc32BootloaderPatchFull) == false)
+    {
+      //Corrupted image, do not boot
+      serialPrintSi468x::printError(11);
+      return;
+    }
+    //DAB Firmware
+    if (bootFirmwareDab() == false) return;
     serialPrintSi468x::printSystemState(readSystemState());
-    //Set device properties
-    writePropertyValueList(propertyValueListDevice, NUM_PROPERTIES_DEVICE);
+    //Set device properties, device just booted
+    writePropertyValueList(propertyValueListDevice, NUM_PROPERTIES_DEVICE, PROPERTIES_DEFAULT);
+    serialPrintSi468x::printPropertyStatistics(propertyStatistics);
     //Set DAB properties
-    writePropertyValueList(propertyValueListDab, NUM_PROPERTIES_DAB);
+    writePropertyValueList(propertyValueListDab, NUM_PROPERTIES_DAB, PROPERTIES_DEFAULT);
+    serialPrintSi468x::printPropertyStatistics(propertyStatistics);
+    propertyShadowValid = true;
     //Tunes DAB inital index
     tuneIndex(index);
     //Starts inital audio service
@@ -816,21 +819,11 @@ void menuDevice(char ch)
   };
 }
 
-unsigned short getFreeRam()
-{
-  extern unsigned int __heap_start;
-  extern unsigned int *__brkval;
-  //test variable created on stack
-  unsigned int newVariable = 0;
-
-  return (unsigned int) &newVariable - (__brkval == 0 ? (unsigned int) &__heap_start : (unsigned int) __brkval);
-}
-
 //Get status of mute
 unsigned char readMute()
 {
   unsigned char channelMuted = 0;
-  channelMuted = readPropertyValue(AUDIO_MUTE);
+  channelMuted = readPropertyValueShadow(AUDIO_MUTE);
   return channelMuted;
 }
 
@@ -849,7 +842,7 @@ void writeMute(unsigned char channelMuted)
 
 unsigned char volumeUp()
 {
-  unsigned char volume = readPropertyValue(AUDIO_ANALOG_VOLUME);
+  unsigned char volume = readPropertyValueShadow(AUDIO_ANALOG_VOLUME);
 
   //volume 0...63;
   if (volume < 63) volume ++;
@@ -861,7 +854,7 @@ unsigned char volumeUp()
 
 unsigned char volumeDown()
 {
-  unsigned char volume = readPropertyValue(AUDIO_ANALOG_VOLUME);
+  unsigned char volume = readPropertyValueShadow(AUDIO_ANALOG_VOLUME);
 
   //volume 0...63;
   if (volume > 0) volume --;
@@ -871,6 +864,102 @@ unsigned char volumeDown()
   return volume;
 }
 
+//Progress of scanJob, valid indices are printed while scanning
+void printScanProgress(const scanJob_t& scanJob, unsigned char event)
+{
+  switch (event)
+  {
+    case SCAN_EVENT_INDEX:
+      if (scanJob.state == SCAN_SEEK)
+      {
+        Serial.print(F("Index:\t"));
+        Serial.println(scanJob.index);
+      }
+      else
+      {
+        Serial.print('.');
+      }
+      break;
+
+    case SCAN_EVENT_CANDIDATE:
+      Serial.print('+');
+      break;
+
+    case SCAN_EVENT_VALID:
+      Serial.println();
+      Serial.print(F("Valid index found:\t"));
+      Serial.println(scanJob.index);
+      break;
+
+    case SCAN_EVENT_DONE:
+      if (scanJob.state == SCAN_SEEK)
+      {
+        if (scanJob.found == 0) Serial.println(F("Nothing found"));
+        Serial.println(index);
+      }
+      else if (scanJob.state == SCAN_DIRECTORY_LIST)
+      {
+        serialPrintSi468x::dabPrintServiceDirectory(serviceDirectory);
+      }
+      else
+      {
+        Serial.println();
+        serialPrintSi468x::dabPrintIndexList(indexListHeader);
+        serialPrintSi468x::dabPrintScanStatistics(scanStatistics);
+      }
+      break;
+
+    case SCAN_EVENT_SERVICE:
+      if (scanJob.found != 0)
+      {
+        serialPrintSi468x::dabPrintEnsemble(ensembleHeader);
+        printServiceLabel();
+      }
+      else
+      {
+        serialPrintSi468x::printError(2);
+      }
+      serialPrintSi468x::printFreeRam(getFreeRam());
+      break;
+
+    case SCAN_EVENT_DIRECTORY:
+      Serial.println();
+      Serial.print(F("Directory index:\t"));
+      Serial.println(scanJob.index);
+      break;
+
+    case SCAN_EVENT_CANCEL:
+      Serial.println();
+      Serial.println(F("Scan cancelled"));
+      break;
+
+    default:
+      break;
+  }
+}
+
+//Print label of actual service from ensemble, reads service information if not parsed
+void printServiceLabel()
+{
+  const char* label = nullptr;
+
+  if (ensembleHeader.numServices != 0 && getServiceId(ensembleHeader.actualService) == serviceId)
+  {
+    label = getServiceLabel(ensembleHeader.actualService);
+  }
+
+  if (label != nullptr)
+  {
+    Serial.println(label);
+  }
+  else
+  {
+    serviceInformation_t serviceInformation;
+    readServiceInformation(serviceInformation, serviceId);
+    Serial.println(serviceInformation.serviceLabel);
+  }
+}
+
 //Test varactor tuning capacitor
 void testVaractorCap(unsigned char& index, unsigned char injection)
 {
@@ -21,8 +21,6 @@ void menuScanFrequency(char ch);
 void menuTechnical(char ch);
 void menuDevice(char ch);
 
-//Get free RAM
-unsigned short getFreeRam();
 //Get status of mute
 unsigned char readMute();
 //Mute 0,1,2,3; No, Left, Rright, Both, default No
@@ -32,6 +30,13 @@ void writeMute(unsigned char channelMuted = 0);
 unsigned char volumeUp();
 unsigned char volumeDown();
 
+//Progress of scanJob, valid indices are printed while scanning
+struct scanJob_t;
+void printScanProgress(const scanJob_t& scanJob, unsigned char event);
+
+//Print label of actual service from ensemble, reads service information if not parsed
+void printServiceLabel();
+
 //Test varactor tuning capacitor
 void testVaractorCap(unsigned char& index, unsigned char injection = 0);
 
@@ -41,6 +41,9 @@ enum firmware_t
   sizeFirmwareDab             = 0x0007F4E8,
   checkSumFirmwareDab         = 0x37A4,
   crc32FirmwareDab            = 0xb5edae86,
+  revisionFirmwareDabMajor    = 5,
+  revisionFirmwareDabMinor    = 0,
+  revisionFirmwareDabBuild    = 5,
 
   //Firmware Image Mode 3 AM
   addrFirmwareAm              = 0x00140000,
@@ -54,6 +57,10 @@ enum firmware_t
   FAVORITE2_ADDRESS           = 0x001E9009,//favorite2, lenght 9 Bytes, uint8_t index, uint32_t serviceId, uint32_t componentId
   FAVORITE3_ADDRESS           = 0x001E9012,//favorite3, lenght 9 Bytes, uint8_t index, uint32_t serviceId, uint32_t componentId
   FAVORITE4_ADDRESS           = 0x001E901B,//favorite3, lenght 9 Bytes, uint8_t index, uint32_t serviceId, uint32_t componentId
+
+  ADDRESS_SERVICE_DIRECTORY   = 0x001EA000,//Service directory, next sector after favorites, 4096 Bytes = header + 127 entries * 32 Bytes
+  ADDRESS_ENSEMBLE_SNAPSHOT   = 0x001EB000,//Snapshot of last parsed ensemble, 16 Bytes header + ensembleArena
+  ADDRESS_SERVICE_DIRECTORY_COPY = 0x001EC000,//Second sector of service directory, valid entries are compacted alternately into both sectors
   //END 0x001F FFFF
 
 };
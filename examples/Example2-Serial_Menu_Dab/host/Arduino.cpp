@@ -0,0 +1,249 @@
+//Arduino core stand-in for the host build
+#include "Arduino.h"
+
+//INTB and RSTB of tuner, pins of shield
+#include "simulatorSi468x.h"
+
+//Costs of core functions on UNO in us, time would not pass in busy loops otherwise
+enum costArduino_t
+{
+  COST_TIME_FUNCTION = 4,//micros(), millis()
+  COST_PIN_FUNCTION  = 4,//digitalRead(), digitalWrite()
+};
+
+hostClock_t hostClock = {0, 0, 0, 0};
+
+HardwareSerial Serial;
+
+//Input queue of Serial
+static char serialInput[1024];
+static unsigned short serialHead = 0;
+static unsigned short serialTail = 0;
+static bool serialEcho = true;
+
+//Keys typed later
+static const char* serialScript = "";
+static unsigned long scriptInterval = 0;
+static unsigned long long scriptNext = 0;
+static bool (*scriptReady)() = nullptr;
+
+void hostAdvance(unsigned long us)
+{
+  hostClock.now += us;
+}
+
+unsigned long millis()
+{
+  hostAdvance(COST_TIME_FUNCTION);
+  return (unsigned long)(hostClock.now / 1000);
+}
+
+unsigned long micros()
+{
+  hostAdvance(COST_TIME_FUNCTION);
+  return (unsigned long) hostClock.now;
+}
+
+void delay(unsigned long ms)
+{
+  hostClock.sleep += ms * 1000;
+  hostAdvance(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  hostClock.sleep += us;
+  hostAdvance(us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  (void) pin;
+  (void) mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  hostAdvance(COST_PIN_FUNCTION);
+  if (pin == PIN_DEVICE_RESET) simulatorSi468x.writeReset(value);
+}
+
+int digitalRead(uint8_t pin)
+{
+  hostAdvance(COST_PIN_FUNCTION);
+  //INTB is active low
+  if (pin == PIN_DEVICE_INTERRUPT) return simulatorSi468x.readInterrupt() ? LOW : HIGH;
+  return HIGH;
+}
+
+void hostSerialInput(const char text[])
+{
+  for (unsigned short i = 0; text[i] != '\0'; i++)
+  {
+    unsigned short next = (serialTail + 1) % sizeof(serialInput);
+    if (next == serialHead) return;
+    serialInput[serialTail] = text[i];
+    serialTail = next;
+  }
+}
+
+void hostSerialScript(const char text[], unsigned long interval, bool (*ready)())
+{
+  serialScript = text;
+  scriptInterval = interval;
+  scriptNext = hostClock.now + interval;
+  scriptReady = ready;
+}
+
+int hostSerialPending()
+{
+  return (serialTail + sizeof(serialInput) - serialHead) % sizeof(serialInput) + strlen(serialScript);
+}
+
+void hostSerialEcho(bool echo)
+{
+  serialEcho = echo;
+}
+
+void HardwareSerial::begin(unsigned long baud)
+{
+  (void) baud;
+}
+
+HardwareSerial::operator bool()
+{
+  return true;
+}
+
+int HardwareSerial::available()
+{
+  //next key of script if previous one was read
+  if (serialHead == serialTail && *serialScript != '\0' && hostClock.now >= scriptNext && (scriptReady == nullptr || scriptReady()))
+  {
+    char key[2] = {*serialScript++, '\0'};
+    hostSerialInput(key);
+    scriptNext = hostClock.now + scriptInterval;
+  }
+  return (serialTail + sizeof(serialInput) - serialHead) % sizeof(serialInput);
+}
+
+int HardwareSerial::read()
+{
+  if (serialHead == serialTail) return -1;
+  char ch = serialInput[serialHead];
+  serialHead = (serialHead + 1) % sizeof(serialInput);
+  return ch;
+}
+
+size_t HardwareSerial::print(const char text[])
+{
+  if (serialEcho) fputs(text, stdout);
+  return strlen(text);
+}
+
+size_t HardwareSerial::print(char ch)
+{
+  if (serialEcho) putchar(ch);
+  return 1;
+}
+
+//Digits without leading zeros like Print::printNumber()
+size_t HardwareSerial::printNumber(unsigned long value, int base)
+{
+  char buf[8 * sizeof(long) + 1];
+  char* str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+
+  if (base < 2) base = 10;
+
+  do
+  {
+    char digit = value % base;
+    value /= base;
+    *--str = digit < 10 ? digit + '0' : digit + 'A' - 10;
+  }
+  while (value != 0);
+
+  return print(str);
+}
+
+size_t HardwareSerial::print(unsigned char value, int base)
+{
+  return printNumber(value, base);
+}
+
+size_t HardwareSerial::print(int value, int base)
+{
+  return print((long) value, base);
+}
+
+size_t HardwareSerial::print(unsigned int value, int base)
+{
+  return printNumber(value, base);
+}
+
+//Negative values in other bases are printed as 32 bit like on AVR
+size_t HardwareSerial::print(long value, int base)
+{
+  if (base != DEC) return printNumber((uint32_t) value, base);
+  if (value >= 0) return printNumber(value, base);
+  return print('-') + printNumber(-value, base);
+}
+
+size_t HardwareSerial::print(unsigned long value, int base)
+{
+  return printNumber(value, base);
+}
+
+size_t HardwareSerial::print(double value, int digits)
+{
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.*f", digits, value);
+  return print(buf);
+}
+
+//Line end \n instead of \r\n for files and terminals of host
+size_t HardwareSerial::println()
+{
+  return print('\n');
+}
+
+size_t HardwareSerial::println(const char text[])
+{
+  return print(text) + println();
+}
+
+size_t HardwareSerial::println(char ch)
+{
+  return print(ch) + println();
+}
+
+size_t HardwareSerial::println(unsigned char value, int base)
+{
+  return print(value, base) + println();
+}
+
+size_t HardwareSerial::println(int value, int base)
+{
+  return print(value, base) + println();
+}
+
+size_t HardwareSerial::println(unsigned int value, int base)
+{
+  return print(value, base) + println();
+}
+
+size_t HardwareSerial::println(long value, int base)
+{
+  return print(value, base) + println();
+}
+
+size_t HardwareSerial::println(unsigned long value, int base)
+{
+  return print(value, base) + println();
+}
+
+size_t HardwareSerial::println(double value, int digits)
+{
+  return print(value, digits) + println();
+}
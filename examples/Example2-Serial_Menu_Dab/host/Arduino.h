@@ -0,0 +1,117 @@
+//include guard
+#ifndef ARDUINO_HOST_H
+#define ARDUINO_HOST_H
+
+/*
+  Arduino core stand-in for the host build
+
+  Time is simulated, delay(), delayMicroseconds(), SPI transfers and calls of time and pin functions
+  advance the clock like on UNO, so polling loops of the driver progress without real waiting.
+  Serial prints to stdout, input of Serial is fed by the host program.
+*/
+
+//uint8_t
+#include <stdint.h>
+#include <stddef.h>
+//snprintf
+#include <stdio.h>
+#include <stdlib.h>
+
+//glibc declares index() in string.h, the driver has a global index like avr-libc allows
+#define index indexLibc
+#include <string.h>
+#undef index
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+//Program memory is data memory on host
+#define PROGMEM
+#define F(string) (string)
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+#define pgm_read_dword(address) (*(const uint32_t*)(address))
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define A0 14
+
+//Time functions of simulated clock in us
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+//Pins, INTB and RSTB of tuner are routed to simulator
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+//Serial monitor on stdout
+class HardwareSerial
+{
+  public:
+    void begin(unsigned long baud);
+    operator bool();
+
+    int available();
+    int read();
+
+    size_t print(const char text[]);
+    size_t print(char ch);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println();
+    size_t println(const char text[]);
+    size_t println(char ch);
+    size_t println(unsigned char value, int base = DEC);
+    size_t println(int value, int base = DEC);
+    size_t println(unsigned int value, int base = DEC);
+    size_t println(long value, int base = DEC);
+    size_t println(unsigned long value, int base = DEC);
+    size_t println(double value, int digits = 2);
+
+  private:
+    size_t printNumber(unsigned long value, int base);
+};
+
+extern HardwareSerial Serial;
+
+//Host only: simulated clock
+struct hostClock_t
+{
+  unsigned long long now;//us since start
+  unsigned long long sleep;//us in delay() and delayMicroseconds()
+  unsigned long spiTransfers;//SPI transfers of tuner and flash
+  unsigned long spiBytes;
+};
+
+extern hostClock_t hostClock;
+
+//Advance simulated clock by us
+void hostAdvance(unsigned long us);
+
+//Host only: keys for Serial.read(), output of Serial on stdout if echo
+void hostSerialInput(const char text[]);
+//Keys are released one at a time every interval us if ready() is true, like typed into serial monitor
+void hostSerialScript(const char text[], unsigned long interval, bool (*ready)());
+//Keys in input queue and script
+int hostSerialPending();
+void hostSerialEcho(bool echo);
+
+#endif //ARDUINO_HOST_H
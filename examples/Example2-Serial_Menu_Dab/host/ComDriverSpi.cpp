@@ -0,0 +1,24 @@
+//ComDriverSpi stand-in for the host build
+#include "ComDriverSpi.h"
+
+//Tuner circuit on the other side of SPI
+#include "simulatorSi468x.h"
+
+ComDriverSpi::ComDriverSpi(uint8_t slaveSelectPin, uint32_t frequency) : slaveSelectPin(slaveSelectPin), frequency(frequency)
+{
+}
+
+void ComDriverSpi::writeSpi(uint8_t data[], uint32_t len, transfer_t transfer)
+{
+  //8 bit per byte at SPI clock
+  hostAdvance(len * 8000000UL / frequency + (transfer == transferEnd ? 0 : 2));
+  hostClock.spiBytes += len;
+  if (transfer != transferEnd) hostClock.spiTransfers++;
+
+  simulatorSi468x.transferSpi(data, len, transfer != transferEnd, transfer != transferStart);
+}
+
+void ComDriverSpi::readSpi(uint8_t data[], uint32_t len, transfer_t transfer)
+{
+  writeSpi(data, len, transfer);
+}
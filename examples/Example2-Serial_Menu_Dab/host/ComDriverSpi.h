@@ -0,0 +1,35 @@
+//include guard
+#ifndef COM_DRIVER_SPI_HOST_H
+#define COM_DRIVER_SPI_HOST_H
+
+/*
+  ComDriverSpi stand-in for the host build
+
+  Transfers go to the simulated Si468x, bytes are exchanged in place like full duplex SPI.
+  8 MHz SPI clock costs 1 us per byte and 2 us per transfer for slave select.
+*/
+
+#include "Arduino.h"
+
+class ComDriverSpi
+{
+  public:
+    enum transfer_t
+    {
+      transferStart,//slave select low, stays low
+      transferEnd,//slave select high after data
+      transferStartEnd//one complete transfer
+    };
+
+    ComDriverSpi(uint8_t slaveSelectPin, uint32_t frequency);
+
+    //Write data, reply of device is written back into data
+    void writeSpi(uint8_t data[], uint32_t len, transfer_t transfer = transferStartEnd);
+    void readSpi(uint8_t data[], uint32_t len, transfer_t transfer = transferStartEnd);
+
+  private:
+    uint8_t slaveSelectPin;
+    uint32_t frequency;
+};
+
+#endif //COM_DRIVER_SPI_HOST_H
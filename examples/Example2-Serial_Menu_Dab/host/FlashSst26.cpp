@@ -0,0 +1,121 @@
+//FlashSst26 stand-in for the host build
+#include "FlashSst26.h"
+
+//mmap
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//Timing of SST26WF016B in us, 8 MHz SPI
+enum timingFlashHost_t
+{
+  FLASH_HOST_COMMAND    = 4 + 2,//command and 24 bit address, slave select
+  FLASH_HOST_PAGE_PROGRAM = 1500,//tPP
+  FLASH_HOST_SECTOR_ERASE = 25000,//tSE
+};
+
+hostFlashStatistics_t hostFlashStatistics = {0, 0, 0, 0};
+
+//One image for all objects like one chip on the shield
+static uint8_t* image = nullptr;
+
+bool hostFlashBegin(const char path[])
+{
+  if (image != nullptr) return false;
+
+  bool created = false;
+
+  int file = open(path, O_RDWR);
+  if (file < 0)
+  {
+    file = open(path, O_RDWR | O_CREAT, 0644);
+    if (file < 0 || ftruncate(file, FLASH_HOST_SIZE) != 0)
+    {
+      perror(path);
+      exit(1);
+    }
+    created = true;
+  }
+
+  struct stat info;
+  if (fstat(file, &info) != 0 || info.st_size != FLASH_HOST_SIZE)
+  {
+    fprintf(stderr, "%s: size of flash image is not %d bytes\n", path, FLASH_HOST_SIZE);
+    exit(1);
+  }
+
+  void* mapped = mmap(nullptr, FLASH_HOST_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+  close(file);
+  if (mapped == MAP_FAILED)
+  {
+    perror(path);
+    exit(1);
+  }
+  image = (uint8_t*) mapped;
+
+  //erased chip
+  if (created) memset(image, 0xff, FLASH_HOST_SIZE);
+
+  return created;
+}
+
+uint8_t* hostFlashImage()
+{
+  return image;
+}
+
+FlashSst26::FlashSst26(uint8_t slaveSelectPin, uint32_t frequency) : slaveSelectPin(slaveSelectPin), frequency(frequency)
+{
+}
+
+void FlashSst26::readData(uint32_t address, uint8_t data[], uint32_t len)
+{
+  hostAdvance(FLASH_HOST_COMMAND + len);
+  hostClock.spiTransfers++;
+  hostClock.spiBytes += len;
+  hostFlashStatistics.reads++;
+  hostFlashStatistics.bytesRead += len;
+
+  for (uint32_t i = 0; i < len; i++)
+  {
+    data[i] = image != nullptr ? image[(address + i) % FLASH_HOST_SIZE] : 0xff;
+  }
+}
+
+void FlashSst26::writePage(uint32_t address, uint8_t data[], uint32_t len)
+{
+  hostAdvance(FLASH_HOST_COMMAND + len + FLASH_HOST_PAGE_PROGRAM);
+  hostClock.spiTransfers++;
+  hostClock.spiBytes += len;
+  hostFlashStatistics.pageWrites++;
+
+  if (image == nullptr) return;
+
+  uint32_t page = address % FLASH_HOST_SIZE & ~(uint32_t)(FLASH_HOST_PAGE_SIZE - 1);
+  for (uint32_t i = 0; i < len; i++)
+  {
+    image[page + (address + i) % FLASH_HOST_PAGE_SIZE] &= data[i];
+  }
+}
+
+void FlashSst26::eraseSector(uint32_t address)
+{
+  hostAdvance(FLASH_HOST_COMMAND + FLASH_HOST_SECTOR_ERASE);
+  hostClock.spiTransfers++;
+  hostFlashStatistics.sectorErases++;
+
+  if (image == nullptr) return;
+
+  memset(&image[address % FLASH_HOST_SIZE & ~(uint32_t)(FLASH_HOST_SECTOR_SIZE - 1)], 0xff, FLASH_HOST_SECTOR_SIZE);
+}
+
+FlashSst26::id_t FlashSst26::readId()
+{
+  hostAdvance(FLASH_HOST_COMMAND);
+  hostClock.spiTransfers++;
+
+  id_t id;
+  id.jedecId = image != nullptr ? (uint32_t) FLASH_HOST_JEDEC_ID : 0xFFFFFF;
+  return id;
+}
@@ -0,0 +1,59 @@
+//include guard
+#ifndef FLASH_SST26_HOST_H
+#define FLASH_SST26_HOST_H
+
+/*
+  FlashSst26 stand-in for the host build
+
+  2 MB of SST26WF016B in a memory-mapped file, so service directory, snapshot and firmware images
+  persist between runs like on the shield. Programming only clears bits, erase sets a 4 kB sector to 0xff.
+*/
+
+#include "Arduino.h"
+
+enum flashSst26Host_t
+{
+  FLASH_HOST_SIZE        = 0x200000,//2 MB
+  FLASH_HOST_SECTOR_SIZE = 0x1000,
+  FLASH_HOST_PAGE_SIZE   = 0x100,
+  FLASH_HOST_JEDEC_ID    = 0xBF2651,//SST, SPI serial flash, SST26WF016B
+};
+
+class FlashSst26
+{
+  public:
+    struct id_t
+    {
+      uint32_t jedecId;
+    };
+
+    FlashSst26(uint8_t slaveSelectPin, uint32_t frequency);
+
+    void readData(uint32_t address, uint8_t data[], uint32_t len);
+    //Program within one page, address wraps at page boundary
+    void writePage(uint32_t address, uint8_t data[], uint32_t len);
+    void eraseSector(uint32_t address);
+    id_t readId();
+
+  private:
+    uint8_t slaveSelectPin;
+    uint32_t frequency;
+};
+
+//Host only: accesses of driver to flash memory
+struct hostFlashStatistics_t
+{
+  unsigned long reads;
+  unsigned long bytesRead;
+  unsigned long pageWrites;
+  unsigned long sectorErases;
+};
+
+extern hostFlashStatistics_t hostFlashStatistics;
+
+//Map image file, created erased if missing, true if created
+bool hostFlashBegin(const char path[]);
+//Mapped image of FLASH_HOST_SIZE bytes, nullptr before hostFlashBegin()
+uint8_t* hostFlashImage();
+
+#endif //FLASH_SST26_HOST_H
@@ -0,0 +1,8 @@
+//include guard
+#ifndef PRINT_SERIAL_FLASH_SST26_HOST_H
+#define PRINT_SERIAL_FLASH_SST26_HOST_H
+
+//PrintSerialFlashSst26 stand-in for the host build, printSerial.cpp uses no function of it
+#include "FlashSst26.h"
+
+#endif //PRINT_SERIAL_FLASH_SST26_HOST_H
@@ -0,0 +1,297 @@
+//Benchmark of driver against simulated Si468x, durations are simulated time of UNO
+#include "Arduino.h"
+
+//Wall clock of host for CPU bound benchmarks
+#include <time.h>
+
+//Driver
+#include "SI468x.h"
+
+//Flash image
+#include "FlashSst26.h"
+
+//Ensembles and statistics of simulated device
+#include "simulatorSi468x.h"
+
+//Fresh flash image, no directory and no snapshot of earlier runs
+static const char pathFlash[] = "build/benchmarkSst26.bin";
+
+//Simulated time in ms
+static double elapsed(unsigned long long start)
+{
+  return (hostClock.now - start) / 1000.0;
+}
+
+//Index of frequency in default table of device
+static uint8_t findIndex(uint32_t frequency)
+{
+  for (uint8_t i = 0; i < sizeof(FREQ_TABLE_DEFAULT) / sizeof(FREQ_TABLE_DEFAULT[0]); i++)
+  {
+    if (FREQ_TABLE_DEFAULT[i] == frequency) return i;
+  }
+  return 0;
+}
+
+//Wait for service list of tuned ensemble, true if services are available
+static bool waitServiceList(unsigned long timeout)
+{
+  unsigned long long start = hostClock.now;
+  while (!updateEnsemble(ensembleHeader))
+  {
+    if (hostClock.now - start >= timeout * 1000ULL) return false;
+    delay(10);
+  }
+  return true;
+}
+
+static void benchmarkBoot()
+{
+  unsigned long long start = hostClock.now;
+  deviceBegin();
+  dabBegin();
+
+  printf("Boot\n");
+  printf("  deviceBegin() and dabBegin()   %9.1f ms\n", elapsed(start));
+  printf("  firmware load                  %9lu ms, %lu Bytes/s\n", loadStatistics.duration, loadStatistics.throughput);
+}
+
+static void benchmarkTune()
+{
+  const uint32_t frequencies[] = {CHAN_5C, CHAN_7B, CHAN_9B, CHAN_11A, CHAN_12C, CHAN_11D, CHAN_5D};
+
+  printf("Tune and service list\n");
+  for (uint8_t i = 0; i < sizeof(frequencies) / sizeof(frequencies[0]); i++)
+  {
+    index = findIndex(frequencies[i]);
+    tuneIndex(index);
+    unsigned short latency = tuneStatistics.latency;
+
+    unsigned long long start = hostClock.now;
+    bool available = waitServiceList(2000);
+
+    printf("  index %2u %6lu kHz  tune %4u ms  ", index, (unsigned long) frequencies[i], latency);
+    if (available) printf("service list %7.1f ms, %2u services\n", elapsed(start), ensembleHeader.numServices);
+    else printf("no service list\n");
+  }
+}
+
+static void benchmarkScan()
+{
+  unsigned long long start = hostClock.now;
+  scanIndices(indexListHeader);
+
+  printf("Band scan\n");
+  printf("  %u indices, %u candidates, %u valid\n", scanStatistics.indices, scanStatistics.candidates, scanStatistics.valid);
+  printf("  fast detect %lu ms, full acquisition %lu ms, total %.1f ms\n", scanStatistics.durationFast, scanStatistics.durationFull, elapsed(start));
+}
+
+static void benchmarkServiceSwitch()
+{
+  index = findIndex(CHAN_11A);
+  tuneIndex(index);
+  waitServiceList(2000);
+  serviceId = getServiceId(0);
+  componentId = getComponentId(0, 0);
+  startService(serviceId, componentId);
+
+  const uint8_t switches = 20;
+  unsigned long long start = hostClock.now;
+  for (uint8_t i = 0; i < switches; i++) nextService(serviceId, componentId);
+
+  printf("Service switch\n");
+  printf("  nextService()                  %9.1f ms per switch\n", elapsed(start) / switches);
+}
+
+//Wall clock of host in s
+static double hostSeconds()
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+//findService() in sorted index of full ensemble on host CPU, linear search for comparison, false on wrong rank
+static bool benchmarkFindService()
+{
+  bool passed = true;
+
+  index = findIndex(CHAN_11D);
+  tuneIndex(index);
+  waitServiceList(2000);
+  uint8_t numServices = ensembleHeader.numServices;
+
+  printf("Service lookup\n");
+
+  //every service at its rank, SId below the lowest is not found
+  unsigned long serviceIds[MAX_NUMBER_SERVICES];
+  unsigned char rank;
+  for (uint8_t i = 0; i < numServices; i++)
+  {
+    serviceIds[i] = getServiceId(ensembleArena.order[i]);
+    if (!findService(ensembleHeader, serviceIds[i], rank) || rank != i) passed = false;
+  }
+  if (numServices == 0 || findService(ensembleHeader, serviceIds[0] - 1, rank)) passed = false;
+
+  const unsigned long rounds = 100000;
+  unsigned long found = 0;
+  double start = hostSeconds();
+  for (unsigned long r = 0; r < rounds; r++)
+  {
+    for (uint8_t i = 0; i < numServices; i++) found += findService(ensembleHeader, serviceIds[i], rank);
+  }
+  double binary = (hostSeconds() - start) / (rounds * numServices) * 1e9;
+
+  start = hostSeconds();
+  for (unsigned long r = 0; r < rounds; r++)
+  {
+    for (uint8_t i = 0; i < numServices; i++)
+    {
+      uint8_t j = 0;
+      while (j < numServices && getServiceId(j) != serviceIds[i]) j++;
+      found += j < numServices;
+    }
+  }
+  double linear = (hostSeconds() - start) / (rounds * numServices) * 1e9;
+
+  printf("  findService() %2u services     %9.1f ns per lookup, linear search %.1f ns\n", numServices, binary, linear);
+  if (found != 2 * rounds * numServices) passed = false;
+  if (!passed) printf("  FAILED lookup\n");
+
+  return passed;
+}
+
+//updateCrc32() on host CPU and verifyFirmware() with simulated SPI reads of flash, false on wrong CRC32
+static bool benchmarkCrc32()
+{
+  bool passed = true;
+
+  printf("CRC32\n");
+
+  //check value of CRC-32/IEEE 802.3
+  const unsigned char check[] = "123456789";
+  unsigned long crc32 = updateCrc32(0, check, sizeof(check) - 1);
+  if (crc32 != 0xCBF43926UL)
+  {
+    printf("  FAILED check value 0x%08lX\n", crc32);
+    passed = false;
+  }
+
+  //chunks of a page like verifyFirmware()
+  static unsigned char data[FLASH_PAGE_SIZE];
+  for (uint16_t i = 0; i < sizeof(data); i++) data[i] = i * 31 + 7;
+
+  const unsigned long chunks = 0x10000;
+  double start = hostSeconds();
+  crc32 = 0;
+  for (unsigned long i = 0; i < chunks; i++) crc32 = updateCrc32(crc32, data, sizeof(data));
+  double seconds = hostSeconds() - start;
+  printf("  updateCrc32() host CPU        %9.1f MB/s, 0x%08lX\n", chunks * sizeof(data) / seconds / 1e6, crc32);
+
+  //flash reads only, CPU time of CRC32 is not part of the simulated clock
+  unsigned long long startFlash = hostClock.now;
+  bool valid = verifyFirmware(addrFirmwareDab, sizeFirmwareDab, crc32FirmwareDab);
+  double duration = elapsed(startFlash);
+  printf("  verifyFirmware() flash reads  %9.1f ms, %lu Bytes/s, %s\n", duration, (unsigned long)(sizeFirmwareDab * 1000.0 / duration), valid ? "ok" : "FAILED");
+  if (!valid) passed = false;
+
+  return passed;
+}
+
+//Service list of driver before ensembleArena, serviceList_t and componentList_t with new[] per ensemble and service
+struct oldComponentList_t
+{
+  unsigned short componentId;
+  unsigned char secondaryFlag:          1;
+  unsigned char conditionalAccessFlag:  1;
+  unsigned char serviceType:            6;
+  unsigned char validFlag:              1;
+};
+
+struct oldServiceList_t
+{
+  unsigned long serviceId;
+  unsigned char dataFlag:               1;
+  unsigned char numComponents:          4;
+  oldComponentList_t* componentList;
+};
+
+//Static tables of driver, sizes of this host, AVR has 16 bit int and pointers and 32 bit long
+static void reportSizes()
+{
+  printf("sizeof x86-64 host, DAB_MAX_SERVICES %u\n", MAX_NUMBER_SERVICES);
+  printf("  ensembleArena         %5u Bytes\n", (unsigned) sizeof(ensembleArena_t));
+  printf("  ensembleHeader        %5u Bytes\n", (unsigned) sizeof(ensembleHeader_t));
+  printf("  ensembleCache         %5u Bytes\n", (unsigned) sizeof(ensembleCache_t));
+  printf("  ensembleDiff          %5u Bytes\n", (unsigned) sizeof(ensembleDiff_t));
+  printf("  frequencyTableHeader  %5u Bytes\n", (unsigned) sizeof(frequencyTableHeader_t));
+  printf("  indexListHeader       %5u Bytes, %u Bytes per valid index\n", (unsigned) sizeof(indexListHeader_t), (unsigned) sizeof(indexList_t));
+  printf("  cifMap                %5u Bytes\n", (unsigned) sizeof(cifMap_t));
+  printf("  scanJob               %5u Bytes\n", (unsigned) sizeof(scanJob_t));
+  printf("  serviceDirectory      %5u Bytes\n", (unsigned) sizeof(serviceDirectory_t));
+  //full ensemble with all components of old list on heap
+  printf("  old service list      %5u Bytes, %u services with %u components on heap\n",
+         (unsigned)(MAX_NUMBER_SERVICES * (sizeof(oldServiceList_t) + MAX_NUMBER_COMPONENTS * sizeof(oldComponentList_t))),
+         MAX_NUMBER_SERVICES, MAX_NUMBER_COMPONENTS);
+}
+
+//readReply() of every command against simulator: CTS read, no fixed sleeps, polls near latency of device
+static bool checkReplyPolls()
+{
+  bool passed = true;
+
+  printf("readReply() polls and sleeps per command\n");
+  printf("  opcode  commands  polls  latency us  wait us  sleep us\n");
+  for (uint16_t opcode = 0; opcode < 256; opcode++)
+  {
+    const simCommandStatistics_t& statistic = simulatorSi468x.statistics[opcode];
+    if (statistic.commands == 0) continue;
+
+    double polls = (double) statistic.polls / statistic.commands;
+    double latency = (double) statistic.latency / statistic.commands;
+    double wait = (double) statistic.wait / statistic.commands;
+    double sleep = (double) statistic.sleep / statistic.commands;
+
+    //CTS is read within one poll interval and SPI transfer of reply, INTB saves polls
+    bool overshoot = wait - latency > DURATION_POLL_REPLY + 200;
+    bool unread = statistic.unread != 0;
+    //at most one poll per DURATION_POLL_REPLY, first poll and one on edge of INTB
+    bool polling = polls > latency / DURATION_POLL_REPLY + 2;
+
+    printf("  0x%02X  %9lu  %5.1f  %10.0f  %7.0f  %8.0f", opcode, statistic.commands, polls, latency, wait, sleep);
+    if (unread) printf("  FAILED %lu without CTS", statistic.unread);
+    if (overshoot) printf("  FAILED wait");
+    if (polling) printf("  FAILED polls");
+    printf("\n");
+
+    if (unread || overshoot || polling) passed = false;
+  }
+  if (simulatorSi468x.overflows != 0)
+  {
+    printf("  FAILED %lu commands while busy\n", simulatorSi468x.overflows);
+    passed = false;
+  }
+  return passed;
+}
+
+int main()
+{
+  remove(pathFlash);
+  if (hostFlashBegin(pathFlash)) simulatorSi468x.writeFirmwareImages(hostFlashImage());
+
+  //Output of driver is not part of benchmark
+  hostSerialEcho(false);
+
+  benchmarkBoot();
+  benchmarkTune();
+  benchmarkScan();
+  benchmarkServiceSwitch();
+
+  reportSizes();
+
+  bool passed = benchmarkFindService();
+  if (!benchmarkCrc32()) passed = false;
+  if (!checkReplyPolls()) passed = false;
+
+  remove(pathFlash);
+  return passed ? 0 : 1;
+}
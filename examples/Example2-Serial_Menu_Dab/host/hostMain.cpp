@@ -0,0 +1,73 @@
+//Host program of the sketch, keys of serial monitor from argument or stdin
+#include "Arduino.h"
+
+//scanJob
+#include "SI468x.h"
+
+//Flash image
+#include "FlashSst26.h"
+
+//Firmware images in new flash image
+#include "simulatorSi468x.h"
+
+//Functions of sketch, dabMenuSerial.h is not included because of its enumerator main
+void setup();
+void loop();
+
+enum hostMain_t
+{
+  HOST_KEY_INTERVAL = 500000,//us between keys
+  HOST_IDLE_TIME    = 5000000,//us after last key until exit
+  HOST_LOOP_COST    = 100,//us per loop() without SPI transfers
+  HOST_MAX_KEYS     = 4096,
+};
+
+//Keys are typed while no scan is running, like a user waits for the result
+static bool readyForKey()
+{
+  return scanJob.state == SCAN_IDLE;
+}
+
+int main(int argc, char* argv[])
+{
+  //Image of SST26 persists between runs, firmware images of firmware.h are written into a new one
+  const char* path = getenv("DAB_FLASH_IMAGE");
+  if (path == nullptr) path = "flashSst26.bin";
+  if (hostFlashBegin(path)) simulatorSi468x.writeFirmwareImages(hostFlashImage());
+
+  //Keys without whitespace
+  static char keys[HOST_MAX_KEYS];
+  unsigned short numKeys = 0;
+  if (argc > 1)
+  {
+    for (unsigned short i = 0; argv[1][i] != '\0' && numKeys < sizeof(keys) - 1; i++)
+    {
+      if (argv[1][i] > ' ') keys[numKeys++] = argv[1][i];
+    }
+  }
+  else
+  {
+    int ch;
+    while ((ch = getchar()) != EOF && numKeys < sizeof(keys) - 1)
+    {
+      if (ch > ' ') keys[numKeys++] = ch;
+    }
+  }
+  keys[numKeys] = '\0';
+
+  setup();
+
+  hostSerialScript(keys, HOST_KEY_INTERVAL, readyForKey);
+
+  //Until all keys are handled and loop() was idle for a while
+  unsigned long long idle = hostClock.now;
+  while (hostSerialPending() != 0 || scanJob.state != SCAN_IDLE || hostClock.now - idle < HOST_IDLE_TIME)
+  {
+    if (hostSerialPending() != 0 || scanJob.state != SCAN_IDLE) idle = hostClock.now;
+    loop();
+    hostAdvance(HOST_LOOP_COST);
+  }
+
+  fflush(stdout);
+  return 0;
+}
@@ -0,0 +1,1400 @@
+//Behavioral simulator of tuner circuit Si468x for the host build
+#include "simulatorSi468x.h"
+
+//Property ids
+#include "properties.h"
+
+//Flash image for FLASH_LOAD
+#include "FlashSst26.h"
+
+//Latencies of device in us until CTS
+enum simulatorTiming_t
+{
+  SIM_LATENCY_DEFAULT       = 100,
+  SIM_LATENCY_POWER_UP      = 2000,
+  SIM_LATENCY_LOAD_INIT     = 200,
+  SIM_LATENCY_HOST_LOAD     = 30,//plus 1 us per 16 bytes
+  SIM_LATENCY_BOOT_DAB      = 198000,//Boot time 198ms at DAB
+  SIM_LATENCY_PROPERTY      = 150,
+  SIM_LATENCY_TUNE          = 500,
+  SIM_LATENCY_SERVICE_LIST  = 1000,//plus 1 us per byte of list
+  SIM_LATENCY_START_SERVICE = 20000,
+  SIM_LATENCY_STOP_SERVICE  = 5000,
+  SIM_LATENCY_SERVICE_INFO  = 1200,
+  SIM_LATENCY_COMPONENT     = 1500,
+  SIM_LATENCY_FREQ_LIST     = 1500,
+  SIM_LATENCY_FLASH_LOAD    = 100,//plus 1 us per 1.25 bytes at 10 MHz secondary SPI
+
+  SIM_SYNC_TIME             = 120,//ms until ensemble is acquired after RSSI time
+  SIM_SERVICE_LIST_DELAY    = 600,//ms after STC until service list is decoded from FIC
+  SIM_DLS_PERIOD            = 4000,//ms between DLS packets of running service
+};
+
+//Bits of INT_CTL_ENABLE
+enum simulatorInterrupt_t
+{
+  SIM_STCIEN    = 1 << 0,
+  SIM_DSRVIEN   = 1 << 4,
+  SIM_DACQIEN   = 1 << 5,
+  SIM_ERRIEN    = 1 << 6,
+  SIM_CTSIEN    = 1 << 7,
+  SIM_DEVNTIEN  = 1 << 13,
+};
+
+SimulatorSi468x simulatorSi468x;
+
+//Defaults of properties after BOOT, AN649
+static const uint16_t propertyDefaults[][2] =
+{
+  {INT_CTL_ENABLE, 0},
+  {INT_CTL_REPEAT, 0},
+  {DIGITAL_IO_OUTPUT_SELECT, 0},
+  {DIGITAL_IO_OUTPUT_SAMPLE_RATE, 48000},
+  {DIGITAL_IO_OUTPUT_FORMAT, 0x1800},
+  {DIGITAL_IO_OUTPUT_FORMAT_OVERRIDES_1, 0},
+  {DIGITAL_IO_OUTPUT_FORMAT_OVERRIDES_2, 0},
+  {DIGITAL_IO_OUTPUT_FORMAT_OVERRIDES_3, 0},
+  {DIGITAL_IO_OUTPUT_FORMAT_OVERRIDES_4, 0},
+  {AUDIO_ANALOG_VOLUME, 63},
+  {AUDIO_MUTE, 0},
+  {AUDIO_OUTPUT_CONFIG, 0},
+  {PIN_CONFIG_ENABLE, 0x0001},
+  {WAKE_TONE_ENABLE, 0},
+  {WAKE_TONE_PERIOD, 250},
+  {WAKE_TONE_FREQ, 750},
+  {WAKE_TONE_AMPLITUDE, 8},
+  {DAB_TUNE_FE_VARM, 0},
+  {DAB_TUNE_FE_VARB, 0},
+  {DAB_TUNE_FE_CFG, 0x0001},
+  {DIGITAL_SERVICE_INT_SOURCE, 0},
+  {DIGITAL_SERVICE_RESTART_DELAY, 200},
+  {DAB_DIGRAD_INTERRUPT_SOURCE, 0},
+  {DAB_DIGRAD_RSSI_HIGH_THRESHOLD, 127},
+  {DAB_DIGRAD_RSSI_LOW_THRESHOLD, 0xFF80},
+  {DAB_VALID_RSSI_TIME, 30},
+  {DAB_VALID_RSSI_THRESHOLD, 12},
+  {DAB_VALID_ACQ_TIME, 2000},
+  {DAB_VALID_SYNC_TIME, 1200},
+  {DAB_VALID_DETECT_TIME, 35},
+  {DAB_EVENT_INTERRUPT_SOURCE, 0},
+  {DAB_EVENT_MIN_SVRLIST_PERIOD, 10},
+  {DAB_EVENT_MIN_SVRLIST_PERIOD_RECONFIG, 10},
+  {DAB_EVENT_MIN_FREQINFO_PERIOD, 5},
+  {DAB_XPAD_ENABLE, 1},
+  {DAB_DRC_OPTION, 0},
+  {DAB_CTRL_DAB_MUTE_ENABLE, 1},
+  {DAB_CTRL_DAB_MUTE_SIGNAL_LEVEL_THRESHOLD, 98},
+  {DAB_CTRL_DAB_MUTE_WIN_THRESHOLD, 1000},
+  {DAB_CTRL_DAB_UNMUTE_WIN_THRESHOLD, 1500},
+  {DAB_CTRL_DAB_MUTE_SIGLOSS_THRESHOLD, 6},
+  {DAB_CTRL_DAB_MUTE_SIGLOW_THRESHOLD, 9},
+  {DAB_ANNOUNCEMENT_ENABLE, 0x07FF}
+};
+
+//Images of flash memory, see firmware.h
+struct simFirmware_t
+{
+  uint32_t address;
+  uint32_t size;
+  uint32_t crc32;
+  uint8_t system;//GET_SYS_STATE after BOOT, 0 patch
+};
+
+static const simFirmware_t firmwares[] =
+{
+  {addrBootloaderPatchMini, sizeBootloaderPatchMini, crc32BootloaderPatchMini, 0},
+  {addrBootloaderPatchFull, sizeBootloaderPatchFull, crc32BootloaderPatchFull, 0},
+  {addrFirmwareFm, sizeFirmwareFm, crc32FirmwareFm, 1},
+  {addrFirmwareDab, sizeFirmwareDab, crc32FirmwareDab, 2},
+  {addrFirmwareAm, sizeFirmwareAm, crc32FirmwareAm, 3},
+};
+
+//CRC32 (IEEE 802.3, zlib) register without inversion, byte table
+static uint32_t crc32Table[256];
+
+static void beginCrc32Table()
+{
+  if (crc32Table[1] != 0) return;
+
+  for (uint32_t i = 0; i < 256; i++)
+  {
+    uint32_t crc = i;
+    for (uint8_t bit = 0; bit < 8; bit++) crc = crc & 1 ? crc >> 1 ^ 0xEDB88320 : crc >> 1;
+    crc32Table[i] = crc;
+  }
+}
+
+static uint32_t updateRegister(uint32_t crc, const uint8_t data[], uint32_t len)
+{
+  for (uint32_t i = 0; i < len; i++) crc = crc >> 8 ^ crc32Table[(crc ^ data[i]) & 0xff];
+  return crc;
+}
+
+//Firmware with size and CRC32 of loaded image, nullptr if unknown
+static const simFirmware_t* findFirmware(uint32_t size, uint32_t crc32)
+{
+  for (uint8_t i = 0; i < sizeof(firmwares) / sizeof(firmwares[0]); i++)
+  {
+    if (firmwares[i].size == size && firmwares[i].crc32 == crc32) return &firmwares[i];
+  }
+  return nullptr;
+}
+
+SimulatorSi468x::SimulatorSi468x()
+{
+  beginCrc32Table();
+
+  secondarySpi = false;
+  numEnsembles = 0;
+  writeReset(LOW);
+  writeReset(HIGH);
+  clearStatistics();
+
+  //Ensembles of presets and boot index of menu
+  simEnsemble_t* ensemble;
+  simService_t* service;
+
+  ensemble = addEnsemble(CHAN_5C, 0x10BC, "DR Deutschland", 42, 18);
+  service = addService(ensemble, 0xD210, "DLF", 4);
+  addComponent(ensemble, service, 0x1, 96);
+  service = addService(ensemble, 0xD220, "DKULTUR", 7);
+  addComponent(ensemble, service, 0x2, 96);
+  service = addService(ensemble, 0xD230, "Dlf Nova", 6);
+  addComponent(ensemble, service, 0x3, 72);
+  service = addService(ensemble, 0x15DC, "sunshine live", 10);
+  addComponent(ensemble, service, 0x15, 72);
+  service = addService(ensemble, 0x15DD, "TOGGO Radio", 15);
+  addComponent(ensemble, service, 0x16, 64);
+  service = addService(ensemble, 0x15DE, "SCHLAGERPARADIES", 11);
+  addComponent(ensemble, service, 0x17, 64);
+  service = addService(ensemble, 0xE0D010B5, "EPG", 0, 1);
+  addComponent(ensemble, service, 0x18, 16);
+
+  ensemble = addEnsemble(CHAN_7B, 0x10E2, "hr Radio", 35, 14);
+  service = addService(ensemble, 0xD361, "hr1", 10);
+  addComponent(ensemble, service, 0x1, 96);
+  service = addService(ensemble, 0xD362, "hr2-kultur", 7);
+  addComponent(ensemble, service, 0x2, 96);
+  service = addService(ensemble, 0xD363, "hr3", 10);
+  addComponent(ensemble, service, 0x3, 96);
+  service = addService(ensemble, 0xD364, "hr4", 11);
+  addComponent(ensemble, service, 0x5, 80);
+  service = addService(ensemble, 0xD367, "hr-iNFO", 1);
+  addComponent(ensemble, service, 0x4, 72);
+
+  ensemble = addEnsemble(CHAN_9B, 0x1001, "ANTENNE DE", 30, 11);
+  service = addService(ensemble, 0x1298, "TOGGO", 15);
+  addComponent(ensemble, service, 0x05, 64);
+  service = addService(ensemble, 0x1299, "ANTENNE BAYERN", 10);
+  addComponent(ensemble, service, 0x06, 80);
+  service = addService(ensemble, 0x129A, "Absolut relax", 14);
+  addComponent(ensemble, service, 0x07, 72);
+  service = addService(ensemble, 0x129B, "ENERGY", 10);
+  addComponent(ensemble, service, 0x08, 72);
+  //announced in service list, no component yet
+  addService(ensemble, 0x129C, "Coming soon", 0);
+
+  ensemble = addEnsemble(CHAN_11A, 0x10B2, "SWR RP", 48, 21);
+  service = addService(ensemble, 0xD3A1, "SWR1 RP", 10);
+  addComponent(ensemble, service, 0x1, 96);
+  service = addService(ensemble, 0xD3A2, "SWR2", 7);
+  addComponent(ensemble, service, 0x2, 96);
+  service = addService(ensemble, 0xD3A3, "SWR3", 10);
+  addComponent(ensemble, service, 0x4, 96);
+  service = addService(ensemble, 0xD3A4, "SWR4 RP", 11);
+  addComponent(ensemble, service, 0x5, 72);
+  service = addService(ensemble, 0xD3A5, "DASDING", 10);
+  addComponent(ensemble, service, 0x6, 72);
+  service = addService(ensemble, 0xD3A6, "SWR Aktuell", 1);
+  addComponent(ensemble, service, 0x7, 64);
+
+  ensemble = addEnsemble(CHAN_12C, 0x10E5, "Hessen Sued", 25, 9);
+  service = addService(ensemble, 0x1B2E, "Radio TEDDY", 15);
+  addComponent(ensemble, service, 0x2, 64);
+  service = addService(ensemble, 0x1B2F, "FFH", 10);
+  addComponent(ensemble, service, 0x3, 80);
+
+  //Full ensemble, more services than arena of driver
+  ensemble = addEnsemble(CHAN_11D, 0x10A1, "BR Bayern", 38, 16);
+  char label[17];
+  for (uint8_t i = 0; i < SIM_MAX_SERVICES; i++)
+  {
+    snprintf(label, sizeof(label), "BR Service %u", i + 1);
+    service = addService(ensemble, 0xD311 + 7 * (uint32_t)((i * 13) % SIM_MAX_SERVICES), label, 1 + i % 15);
+    addComponent(ensemble, service, 0x10 + i, 24);
+  }
+
+  //Fast detect passes, no acquisition
+  ensemble = addEnsemble(CHAN_5D, 0, "", 15, 2);
+  ensemble->acquires = 0;
+  ensemble->fastDect = 6;
+}
+
+void SimulatorSi468x::clearStatistics()
+{
+  for (uint16_t i = 0; i < 256; i++)
+  {
+    statistics[i].commands = 0;
+    statistics[i].polls = 0;
+    statistics[i].unread = 0;
+    statistics[i].wait = 0;
+    statistics[i].sleep = 0;
+    statistics[i].latency = 0;
+  }
+  overflows = 0;
+}
+
+void SimulatorSi468x::removeEnsembles()
+{
+  numEnsembles = 0;
+}
+
+simEnsemble_t* SimulatorSi468x::addEnsemble(uint32_t frequency, uint16_t ensembleId, const char label[], int8_t rssi, int8_t snr)
+{
+  if (numEnsembles == SIM_MAX_ENSEMBLES) return nullptr;
+
+  simEnsemble_t* ensemble = &ensembles[numEnsembles++];
+  ensemble->frequency = frequency;
+  ensemble->ensembleId = ensembleId;
+  snprintf(ensemble->label, sizeof(ensemble->label), "%s", label);
+  ensemble->ecc = 0xE0;
+  //versions of ensembles differ, a retune must not look like a reconfiguration
+  ensemble->version = numEnsembles;
+  ensemble->rssi = rssi;
+  ensemble->snr = snr;
+  ensemble->cnr = snr + 4;
+  ensemble->ficQuality = snr > 10 ? 100 : 60 + 4 * snr;
+  ensemble->fastDect = 8 + snr / 2;
+  ensemble->acquires = 1;
+  ensemble->usedCU = 0;
+  ensemble->numServices = 0;
+  return ensemble;
+}
+
+simService_t* SimulatorSi468x::addService(simEnsemble_t* ensemble, uint32_t serviceId, const char label[], uint8_t programType, uint8_t dataFlag)
+{
+  if (ensemble == nullptr || ensemble->numServices == SIM_MAX_SERVICES) return nullptr;
+
+  simService_t* service = &ensemble->services[ensemble->numServices++];
+  service->serviceId = serviceId;
+  snprintf(service->label, sizeof(service->label), "%s", label);
+  service->programType = programType;
+  service->dataFlag = dataFlag;
+  service->numComponents = 0;
+  return service;
+}
+
+//Sub-channel of component follows the last one in CIF, EEP-3A for audio, packet mode for data
+void SimulatorSi468x::addComponent(simEnsemble_t* ensemble, simService_t* service, uint16_t componentId, uint16_t bitRate)
+{
+  if (ensemble == nullptr || service == nullptr || service->numComponents == SIM_MAX_COMPONENTS) return;
+
+  simComponent_t& component = service->components[service->numComponents++];
+  component.componentId = componentId;
+  component.componentType = service->dataFlag ? 60 : 63;
+  component.serviceMode = service->dataFlag ? 2 : 3;
+  component.protectionInfo = 0x22;
+  component.bitRate = bitRate;
+  component.addressCU = ensemble->usedCU;
+  component.numberCU = bitRate * 3 / 4;
+  ensemble->usedCU += component.numberCU;
+}
+
+bool SimulatorSi468x::removeService(simEnsemble_t* ensemble, uint32_t serviceId)
+{
+  for (uint8_t i = 0; ensemble != nullptr && i < ensemble->numServices; i++)
+  {
+    if (ensemble->services[i].serviceId != serviceId) continue;
+
+    ensemble->numServices--;
+    for (; i < ensemble->numServices; i++) ensemble->services[i] = ensemble->services[i + 1];
+    return true;
+  }
+  return false;
+}
+
+simEnsemble_t* SimulatorSi468x::findEnsemble(uint32_t frequency)
+{
+  for (uint8_t i = 0; i < numEnsembles; i++)
+  {
+    if (ensembles[i].frequency == frequency) return &ensembles[i];
+  }
+  return nullptr;
+}
+
+void SimulatorSi468x::reconfigure(simEnsemble_t* ensemble)
+{
+  if (ensemble == nullptr) return;
+
+  ensemble->version++;
+
+  //service list of tuned ensemble changes now
+  if (ensemble == tunedEnsemble() && acquired)
+  {
+    eventInterrupts |= 1 << 7 | 1;
+    serviceListSignalled = true;
+  }
+}
+
+//Ensemble on tuned index, nullptr if none
+simEnsemble_t* SimulatorSi468x::tunedEnsemble()
+{
+  if (state != SIM_STATE_APPLICATION || tunedIndex >= numFrequencies) return nullptr;
+  return findEnsemble(frequencies[tunedIndex]);
+}
+
+//Fill firmware regions with pseudo random data, last 4 bytes are chosen so that CRC32 matches
+void SimulatorSi468x::writeFirmwareImages(uint8_t image[])
+{
+  for (uint8_t f = 0; f < sizeof(firmwares) / sizeof(firmwares[0]); f++)
+  {
+    uint8_t* data = &image[firmwares[f].address];
+    uint32_t size = firmwares[f].size;
+
+    uint32_t random = firmwares[f].address | 1;
+    for (uint32_t i = 0; i < size - 4; i++)
+    {
+      random ^= random << 13;
+      random ^= random >> 17;
+      random ^= random << 5;
+      data[i] = random;
+    }
+
+    //register before last 4 bytes, target register after them
+    uint32_t prefix = updateRegister(0xFFFFFFFF, data, size - 4);
+    uint32_t target = ~firmwares[f].crc32;
+
+    //CRC is affine in the last 32 bits, solve with Gaussian elimination
+    uint8_t zero[4] = {0, 0, 0, 0};
+    uint32_t offset = updateRegister(prefix, zero, 4);
+    uint32_t columns[32];
+    for (uint8_t bit = 0; bit < 32; bit++)
+    {
+      uint8_t unit[4] = {0, 0, 0, 0};
+      unit[bit / 8] = 1 << (bit % 8);
+      columns[bit] = updateRegister(prefix, unit, 4) ^ offset;
+    }
+
+    //rows of system as bit masks: equation bit r, coefficients of 32 unknowns and right side
+    uint64_t rows[32];
+    for (uint8_t r = 0; r < 32; r++)
+    {
+      uint64_t row = (uint64_t)((target ^ offset) >> r & 1) << 32;
+      for (uint8_t bit = 0; bit < 32; bit++) row |= (uint64_t)(columns[bit] >> r & 1) << bit;
+      rows[r] = row;
+    }
+    for (uint8_t bit = 0; bit < 32; bit++)
+    {
+      uint8_t pivot = bit;
+      while (pivot < 32 && (rows[pivot] >> bit & 1) == 0) pivot++;
+      if (pivot == 32) continue;
+
+      uint64_t swap = rows[bit];
+      rows[bit] = rows[pivot];
+      rows[pivot] = swap;
+
+      for (uint8_t r = 0; r < 32; r++)
+      {
+        if (r != bit && (rows[r] >> bit & 1)) rows[r] ^= rows[bit];
+      }
+    }
+
+    uint32_t patch = 0;
+    for (uint8_t bit = 0; bit < 32; bit++) patch |= (uint32_t)(rows[bit] >> 32 & 1) << bit;
+
+    for (uint8_t i = 0; i < 4; i++) data[size - 4 + i] = patch >> (8 * i);
+
+    if (~updateRegister(0xFFFFFFFF, data, size) != firmwares[f].crc32)
+    {
+      fprintf(stderr, "CRC32 of firmware image at 0x%06X does not match\n", (unsigned) firmwares[f].address);
+      exit(1);
+    }
+  }
+}
+
+void SimulatorSi468x::writeReset(uint8_t level)
+{
+  if (level == LOW)
+  {
+    inReset = true;
+    return;
+  }
+  if (!inReset) return;
+
+  //Waiting for POWER_UP
+  inReset = false;
+  state = SIM_STATE_RESET;
+  cts = true;
+  ctsInterrupt = false;
+  error = false;
+  commandOverflow = false;
+  nonRecoverable = false;
+  readyTime = 0;
+  lenCommand = 0;
+  readingReply = false;
+  lenResponse = 0;
+  readOffset = 0;
+  waitingCts = false;
+  loadedSize = 0;
+  loadedCrc32 = 0xFFFFFFFF;
+  patchLoaded = false;
+  booting = false;
+  tuning = false;
+  acquired = false;
+  serviceRunning = false;
+  for (uint8_t i = 0; i < sizeof(powerUpArguments); i++) powerUpArguments[i] = 0;
+  for (uint16_t i = 0; i < SIM_STORAGE_SIZE; i++) storage[i] = 0;
+}
+
+//Defaults of DAB application after BOOT
+void SimulatorSi468x::resetApplication()
+{
+  numProperties = sizeof(propertyDefaults) / sizeof(propertyDefaults[0]);
+  for (uint8_t i = 0; i < numProperties; i++)
+  {
+    properties[i][0] = propertyDefaults[i][0];
+    properties[i][1] = propertyDefaults[i][1];
+  }
+
+  numFrequencies = sizeof(FREQ_TABLE_DEFAULT) / sizeof(FREQ_TABLE_DEFAULT[0]);
+  for (uint8_t i = 0; i < numFrequencies; i++) frequencies[i] = FREQ_TABLE_DEFAULT[i];
+
+  tunedIndex = 0;
+  tuning = false;
+  acquired = false;
+  stcInterrupt = 0;
+  digradInterrupts = 0;
+  eventInterrupts = 0;
+  serviceListSignalled = false;
+  serviceRunning = false;
+  dlsHead = 0;
+  dlsSize = 0;
+  dlsCount = 0;
+  dsrvOverflow = false;
+}
+
+//Device state at actual time of simulated clock
+void SimulatorSi468x::update()
+{
+  unsigned long long now = hostClock.now;
+
+  if (!cts && now >= readyTime)
+  {
+    cts = true;
+    ctsInterrupt = true;
+
+    //Application starts with CTS of BOOT
+    if (booting)
+    {
+      booting = false;
+      state = SIM_STATE_APPLICATION;
+      resetApplication();
+    }
+  }
+
+  if (state != SIM_STATE_APPLICATION) return;
+
+  //Seek tune complete
+  if (tuning && now >= stcTime)
+  {
+    tuning = false;
+    simEnsemble_t* ensemble = tunedEnsemble();
+    acquired = ensemble != nullptr && ensemble->acquires;
+    stcInterrupt = 1;
+
+    //acquisition state changed
+    if (acquired) digradInterrupts |= 1 << 2;
+
+    serviceListTime = stcTime + SIM_SERVICE_LIST_DELAY * 1000ULL;
+    serviceListSignalled = false;
+  }
+
+  //Service list decoded from FIC
+  if (acquired && !serviceListSignalled && now >= serviceListTime)
+  {
+    serviceListSignalled = true;
+    eventInterrupts |= 1;
+  }
+
+  //DLS of running audio service
+  while (serviceRunning && (readProperty(DAB_XPAD_ENABLE) & 1) && now >= nextDlsTime)
+  {
+    queueDls();
+    nextDlsTime += SIM_DLS_PERIOD * 1000ULL;
+  }
+}
+
+//Status byte of reply
+uint8_t SimulatorSi468x::readStatus(uint8_t position)
+{
+  bool application = state == SIM_STATE_APPLICATION;
+
+  if (position == 0)
+  {
+    uint8_t digrad = application ? digradInterrupts & readProperty(DAB_DIGRAD_INTERRUPT_SOURCE) : 0;
+    bool dsrv = application && (readProperty(DIGITAL_SERVICE_INT_SOURCE) & ((dlsSize != 0) | dsrvOverflow << 1));
+
+    return cts << 7 | (cts && error) << 6 | (digrad != 0) << 5 | dsrv << 4 | (application ? stcInterrupt : 0);
+  }
+  if (position == 1)
+  {
+    bool event = application && (eventInterrupts & readProperty(DAB_EVENT_INTERRUPT_SOURCE));
+    return event << 5;
+  }
+  if (position == 3)
+  {
+    return state << 6 | commandOverflow << 2 | nonRecoverable;
+  }
+  return 0;
+}
+
+bool SimulatorSi468x::readInterrupt()
+{
+  update();
+
+  if (inReset || state == SIM_STATE_RESET) return false;
+
+  uint16_t enable;
+  if (state == SIM_STATE_APPLICATION) enable = readProperty(INT_CTL_ENABLE);
+  else enable = powerUpArguments[1] & SIM_CTSIEN;
+
+  uint8_t status = readStatus(0);
+  uint8_t status1 = readStatus(1);
+
+  return ((enable & SIM_CTSIEN) && ctsInterrupt)
+         || ((enable & SIM_ERRIEN) && (status >> 6 & 1))
+         || ((enable & SIM_DACQIEN) && (status >> 5 & 1))
+         || ((enable & SIM_DSRVIEN) && (status >> 4 & 1))
+         || ((enable & SIM_STCIEN) && (status & 1))
+         || ((enable & SIM_DEVNTIEN) && (status1 >> 5 & 1));
+}
+
+void SimulatorSi468x::transferSpi(uint8_t data[], uint32_t len, bool start, bool end)
+{
+  update();
+
+  if (start)
+  {
+    lenCommand = 0;
+    readingReply = false;
+  }
+
+  for (uint32_t i = 0; i < len; i++)
+  {
+    if (inReset)
+    {
+      data[i] = 0x00;
+      continue;
+    }
+
+    //RD_REPLY, following bytes are status and response
+    if (readingReply)
+    {
+      //CTS is read with the status byte, the clock of a transfer is advanced before it
+      if (positionReply == 0 && waitingCts && cts)
+      {
+        simCommandStatistics_t& statistic = statistics[opcode];
+        statistic.polls += polls;
+        statistic.wait += hostClock.now - commandTime;
+        statistic.sleep += hostClock.sleep - commandSleep;
+        waitingCts = false;
+      }
+
+      if (positionReply < 4) data[i] = readStatus(positionReply);
+      else if (readOffset + positionReply - 4 < lenResponse) data[i] = response[readOffset + positionReply - 4];
+      else data[i] = 0;
+      positionReply++;
+      continue;
+    }
+
+    if (lenCommand == 0 && data[i] == READ_REPLY)
+    {
+      readingReply = true;
+      positionReply = 0;
+
+      //polls of host until CTS is read
+      if (waitingCts) polls++;
+      continue;
+    }
+
+    if (lenCommand < SIM_COMMAND_SIZE) command[lenCommand++] = data[i];
+  }
+
+  if (end && !readingReply && lenCommand != 0 && !inReset) execute();
+}
+
+unsigned long SimulatorSi468x::latency(uint8_t opcode)
+{
+  switch (opcode)
+  {
+    case POWER_UP:                 return SIM_LATENCY_POWER_UP;
+    case LOAD_INIT:                return SIM_LATENCY_LOAD_INIT;
+    case HOST_LOAD:                return SIM_LATENCY_HOST_LOAD + lenCommand / 16;
+    case SET_PROPERTY:             return SIM_LATENCY_PROPERTY;
+    case GET_PROPERTY:             return SIM_LATENCY_DEFAULT + 20 * command[1];
+    case DAB_TUNE_FREQ:            return SIM_LATENCY_TUNE;
+    case START_DIGITAL_SERVICE:    return SIM_LATENCY_START_SERVICE;
+    case STOP_DIGITAL_SERVICE:     return SIM_LATENCY_STOP_SERVICE;
+    case DAB_GET_SERVICE_INFO:     return SIM_LATENCY_SERVICE_INFO;
+    case DAB_GET_COMPONENT_INFO:   return SIM_LATENCY_COMPONENT;
+    case DAB_SET_FREQ_LIST:        return SIM_LATENCY_FREQ_LIST;
+    case DAB_GET_SERVICE_LINKING_INFO: return SIM_LATENCY_COMPONENT;
+    case DAB_GET_ENSEMBLE_INFO:
+    case DAB_GET_SUBCHAN_INFO:
+    case DAB_GET_AUDIO_INFO:       return 3 * SIM_LATENCY_DEFAULT;
+    default:                       return SIM_LATENCY_DEFAULT;
+  }
+}
+
+void SimulatorSi468x::replyByte(uint16_t position, uint8_t value)
+{
+  if (position >= SIM_REPLY_SIZE) return;
+  response[position] = value;
+  if (position >= lenResponse) lenResponse = position + 1;
+}
+
+void SimulatorSi468x::replyWord(uint16_t position, uint16_t value)
+{
+  replyByte(position, value & 0xff);
+  replyByte(position + 1, value >> 8);
+}
+
+void SimulatorSi468x::replyLong(uint16_t position, uint32_t value)
+{
+  replyWord(position, value & 0xffff);
+  replyWord(position + 2, value >> 16);
+}
+
+//ERR with error code in first byte of response
+void SimulatorSi468x::replyError(uint8_t code)
+{
+  error = true;
+  lenResponse = 0;
+  replyByte(0, code);
+}
+
+//16 bit argument of command, false if command is too short
+bool SimulatorSi468x::readCommandWord(uint16_t position, uint16_t& value)
+{
+  if (position + 1 >= lenCommand) return false;
+  value = (uint16_t)command[position + 1] << 8 | command[position];
+  return true;
+}
+
+void SimulatorSi468x::execute()
+{
+  //Command while busy is dropped
+  if (!cts)
+  {
+    commandOverflow = true;
+    overflows++;
+    return;
+  }
+
+  //CTS of last command was not read
+  if (waitingCts) statistics[opcode].unread++;
+
+  opcode = command[0];
+  waitingCts = true;
+  polls = 0;
+  commandTime = hostClock.now;
+  commandSleep = hostClock.sleep;
+
+  cts = false;
+  ctsInterrupt = false;
+  error = false;
+  commandOverflow = false;
+  readyTime = hostClock.now + latency(opcode);
+
+  //READ_OFFSET keeps response
+  if (opcode == READ_OFFSET)
+  {
+    uint16_t offset = 0;
+    readCommandWord(2, offset);
+    if (offset % 4 != 0 || offset >= SIM_REPLY_SIZE) replyError(SIM_ERROR_BAD_ARGUMENT);
+    else readOffset = offset;
+  }
+  else
+  {
+    lenResponse = 0;
+    readOffset = 0;
+
+    bool application = state == SIM_STATE_APPLICATION;
+    bool bootloader = state == SIM_STATE_BOOTLOADER;
+
+    switch (opcode)
+    {
+      case POWER_UP:
+        if (state == SIM_STATE_RESET) powerUp();
+        else replyError(SIM_ERROR_BAD_COMMAND);
+        break;
+
+      case LOAD_INIT:
+        if (bootloader) loadInit();
+        else replyError(SIM_ERROR_BAD_COMMAND);
+        break;
+
+      case HOST_LOAD:
+        if (bootloader) hostLoad();
+        else replyError(SIM_ERROR_BAD_COMMAND);
+        break;
+
+      case FLASH_LOAD:
+        if (bootloader) flashLoad();
+        else replyError(SIM_ERROR_BAD_COMMAND);
+        break;
+
+      case BOOT:
+        if (bootloader) boot();
+        else replyError(SIM_ERROR_BAD_COMMAND);
+        break;
+
+      case GET_PART_INFO:
+        replyByte(0, 2);//chip revision
+        replyByte(1, 0);//ROM id
+        replyWord(4, 4688);
+        replyWord(8, 0);
+        break;
+
+      case GET_SYS_STATE:
+        replyByte(0, application ? 2 : 0xE0);//DAB, bootloader
+        break;
+
+      case GET_POWER_UP_ARGS:
+        replyByte(1, 0);
+        replyByte(2, powerUpArguments[2]);
+        replyByte(3, powerUpArguments[3]);
+        for (uint8_t i = 0; i < 4; i++) replyByte(4 + i, powerUpArguments[4 + i]);
+        replyByte(8, powerUpArguments[8]);
+        replyByte(13, powerUpArguments[13]);
+        break;
+
+      case GET_FUNC_INFO:
+        if (!application)
+        {
+          replyError(SIM_ERROR_BAD_COMMAND);
+          break;
+        }
+        replyByte(0, revisionFirmwareDabMajor);
+        replyByte(1, revisionFirmwareDabMinor);
+        replyByte(2, revisionFirmwareDabBuild);
+        replyByte(3, 1 << 7);//no SVN
+        replyLong(4, 0);
+        break;
+
+      case SET_PROPERTY:
+        if (application) setProperty();
+        else replyError(SIM_ERROR_BAD_COMMAND);
+        break;
+
+      case GET_PROPERTY:
+        if (application) getProperty();
+        else replyError(SIM_ERROR_BAD_COMMAND);
+        break;
+
+      case WRITE_STORAGE:
+      {
+        uint16_t offset = 0;
+        uint16_t len = 0;
+        readCommandWord(2, offset);
+        readCommandWord(4, len);
+        if (!application || offset + len > SIM_STORAGE_SIZE || lenCommand < 8 + len)
+        {
+          replyError(SIM_ERROR_BAD_ARGUMENT);
+          break;
+        }
+        for (uint16_t i = 0; i < len; i++) storage[offset + i] = command[8 + i];
+        break;
+      }
+
+      case READ_STORAGE:
+      {
+        uint16_t offset = 0;
+        readCommandWord(2, offset);
+        if (!application || offset >= SIM_STORAGE_SIZE)
+        {
+          replyError(SIM_ERROR_BAD_ARGUMENT);
+          break;
+        }
+        for (uint16_t i = offset; i < SIM_STORAGE_SIZE && i < offset + 256; i++) replyByte(i - offset, storage[i]);
+        break;
+      }
+
+      case TEST_GET_RSSI:
+      {
+        simEnsemble_t* ensemble = tunedEnsemble();
+        replyWord(0, (uint16_t)((ensemble != nullptr ? ensemble->rssi : 8) << 8));
+        break;
+      }
+
+      default:
+        if (!application)
+        {
+          replyError(SIM_ERROR_BAD_COMMAND);
+          break;
+        }
+
+        switch (opcode)
+        {
+          case GET_DIGITAL_SERVICE_LIST:      serviceList(); break;
+          case START_DIGITAL_SERVICE:         startService(true); break;
+          case STOP_DIGITAL_SERVICE:          startService(false); break;
+          case GET_DIGITAL_SERVICE_DATA:      serviceData(); break;
+          case DAB_TUNE_FREQ:                 tune(); break;
+          case DAB_DIGRAD_STATUS:             digradStatus(); break;
+          case DAB_GET_EVENT_STATUS:          eventStatus(); break;
+          case DAB_GET_ENSEMBLE_INFO:         ensembleInfo(); break;
+          case DAB_SET_FREQ_LIST:             setFrequencyList(); break;
+          case DAB_GET_FREQ_LIST:             getFrequencyList(); break;
+          case DAB_GET_COMPONENT_INFO:        componentInfo(); break;
+          case DAB_GET_TIME:                  dateTime(); break;
+          case DAB_GET_AUDIO_INFO:            audioInfo(); break;
+          case DAB_GET_SUBCHAN_INFO:          subchannelInfo(); break;
+          case DAB_GET_SERVICE_INFO:          serviceInfo(); break;
+
+          //No linking and no frequency information in simulated ensembles
+          case DAB_GET_SERVICE_LINKING_INFO:
+          case DAB_GET_FREQ_INFO:
+            replyLong(0, 0);
+            replyLong(4, 0);
+            break;
+
+          default:
+            replyError(SIM_ERROR_BAD_COMMAND);
+            break;
+        }
+        break;
+    }
+  }
+
+  statistics[opcode].commands++;
+  statistics[opcode].latency += readyTime - hostClock.now;
+}
+
+void SimulatorSi468x::powerUp()
+{
+  for (uint8_t i = 0; i < sizeof(powerUpArguments) && i < lenCommand; i++) powerUpArguments[i] = command[i];
+  state = SIM_STATE_BOOTLOADER;
+}
+
+//Image loaded before is applied if it is a patch
+void SimulatorSi468x::loadInit()
+{
+  const simFirmware_t* firmware = findFirmware(loadedSize, ~loadedCrc32);
+  if (firmware != nullptr && firmware->system == 0) patchLoaded = true;
+
+  loadedSize = 0;
+  loadedCrc32 = 0xFFFFFFFF;
+}
+
+void SimulatorSi468x::hostLoad()
+{
+  if (lenCommand <= 4 || lenCommand > 4 + 0x1000)
+  {
+    replyError(SIM_ERROR_BAD_ARGUMENT);
+    return;
+  }
+  loadedCrc32 = updateRegister(loadedCrc32, &command[4], lenCommand - 4);
+  loadedSize += lenCommand - 4;
+}
+
+//Image of known address is read over secondary SPI bus
+void SimulatorSi468x::flashLoad()
+{
+  uint32_t address = (uint32_t)command[7] << 24 | (uint32_t)command[6] << 16 | (uint32_t)command[5] << 8 | command[4];
+
+  const simFirmware_t* firmware = nullptr;
+  for (uint8_t i = 0; i < sizeof(firmwares) / sizeof(firmwares[0]); i++)
+  {
+    if (firmwares[i].address == address) firmware = &firmwares[i];
+  }
+  if (lenCommand < 12 || firmware == nullptr)
+  {
+    replyError(SIM_ERROR_BAD_ARGUMENT);
+    return;
+  }
+
+  uint8_t* image = hostFlashImage();
+  loadedSize = firmware->size;
+  loadedCrc32 = 0xFFFFFFFF;
+  for (uint32_t i = 0; i < firmware->size; i++)
+  {
+    //without secondary SPI bus MISO stays high
+    uint8_t data = secondarySpi && image != nullptr ? image[address + i] : 0xff;
+    loadedCrc32 = updateRegister(loadedCrc32, &data, 1);
+  }
+
+  readyTime += firmware->size * 4 / 5;
+}
+
+//DAB firmware after patch starts application, other images are not simulated
+void SimulatorSi468x::boot()
+{
+  const simFirmware_t* firmware = findFirmware(loadedSize, ~loadedCrc32);
+
+  if (!patchLoaded || firmware == nullptr || firmware->system != 2)
+  {
+    nonRecoverable = true;
+    replyError(SIM_ERROR_BAD_IMAGE);
+    return;
+  }
+
+  booting = true;
+  readyTime = hostClock.now + SIM_LATENCY_BOOT_DAB;
+}
+
+uint16_t* SimulatorSi468x::findProperty(uint16_t id)
+{
+  for (uint8_t i = 0; i < numProperties; i++)
+  {
+    if (properties[i][0] == id) return &properties[i][1];
+  }
+  return nullptr;
+}
+
+uint16_t SimulatorSi468x::readProperty(uint16_t id)
+{
+  uint16_t* value = findProperty(id);
+  return value != nullptr ? *value : 0;
+}
+
+void SimulatorSi468x::setProperty()
+{
+  uint16_t id;
+  uint16_t value;
+  if (!readCommandWord(2, id) || !readCommandWord(4, value))
+  {
+    replyError(SIM_ERROR_BAD_ARGUMENT);
+    return;
+  }
+
+  uint16_t* property = findProperty(id);
+  if (property == nullptr)
+  {
+    replyError(SIM_ERROR_BAD_PROPERTY);
+    return;
+  }
+  *property = value;
+}
+
+//Contiguous ids from id, 2 bytes per value
+void SimulatorSi468x::getProperty()
+{
+  uint8_t count = command[1];
+  uint16_t id;
+  if (count == 0 || !readCommandWord(2, id))
+  {
+    replyError(SIM_ERROR_BAD_ARGUMENT);
+    return;
+  }
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    uint16_t* property = findProperty(id + i);
+    if (property == nullptr)
+    {
+      replyError(SIM_ERROR_BAD_PROPERTY);
+      return;
+    }
+    replyWord(2 * i, *property);
+  }
+}
+
+//Acquisition with timing of DAB_VALID_* properties, STCINT after RSSI, detect or acquisition time
+void SimulatorSi468x::tune()
+{
+  uint8_t index = command[2];
+  if (lenCommand < 6 || index >= numFrequencies)
+  {
+    replyError(SIM_ERROR_BAD_ARGUMENT);
+    return;
+  }
+
+  tunedIndex = index;
+  tuning = true;
+  acquired = false;
+  stcInterrupt = 0;
+  serviceListSignalled = true;
+  eventInterrupts = 0;
+
+  //services stop at tune
+  serviceRunning = false;
+  dlsSize = 0;
+  dsrvOverflow = false;
+
+  simEnsemble_t* ensemble = findEnsemble(frequencies[index]);
+
+  unsigned long rssiTime = readProperty(DAB_VALID_RSSI_TIME);
+  unsigned long acqTime = readProperty(DAB_VALID_ACQ_TIME);
+  unsigned long detectTime = readProperty(DAB_VALID_DETECT_TIME);
+
+  //0 is not considered
+  if (acqTime == 0) acqTime = SIM_SYNC_TIME;
+  if (detectTime == 0) detectTime = acqTime;
+
+  unsigned long duration;
+  if (ensemble != nullptr && ensemble->acquires) duration = rssiTime + (acqTime < SIM_SYNC_TIME ? acqTime : (unsigned long) SIM_SYNC_TIME);
+  else if (ensemble != nullptr) duration = rssiTime + acqTime;
+  else duration = rssiTime + (detectTime < acqTime ? detectTime : acqTime);
+
+  stcTime = readyTime + duration * 1000ULL;
+}
+
+void SimulatorSi468x::digradStatus()
+{
+  uint8_t arg = command[1];
+
+  //STC_ACK and DIGRAD_ACK
+  if (arg & 1) stcInterrupt = 0;
+
+  simEnsemble_t* ensemble = tuning ? nullptr : tunedEnsemble();
+  uint8_t index = tunedIndex;
+
+  //noise without ensemble
+  int8_t rssi = tuning ? 0 : 6 + index % 5;
+  int8_t snr = 0;
+  uint8_t cnr = 0;
+  uint8_t ficQuality = 0;
+  uint8_t fastDect = tuning ? 0 : index % 4;
+  uint16_t cuLevel = 0;
+
+  if (ensemble != nullptr)
+  {
+    //small variation over time
+    int8_t jitter = hostClock.now / 1000000 % 3;
+    rssi = ensemble->rssi + jitter - 1;
+    snr = ensemble->snr;
+    cnr = ensemble->cnr;
+    ficQuality = acquired ? ensemble->ficQuality : 0;
+    fastDect = ensemble->fastDect;
+    cuLevel = acquired ? ensemble->usedCU : 0;
+  }
+
+  replyByte(0, digradInterrupts);
+  replyByte(1, acquired << 2 | acquired);
+  replyByte(2, rssi);
+  replyByte(3, snr);
+  replyByte(4, ficQuality);
+  replyByte(5, cnr);
+  replyWord(6, 0);
+  replyLong(8, frequencies[index]);
+  replyByte(12, index);
+  replyByte(13, 0);
+  replyWord(14, 0);
+  replyWord(16, cuLevel);
+  replyByte(18, fastDect);
+
+  if (arg & 1 << 3) digradInterrupts = 0;
+}
+
+void SimulatorSi468x::eventStatus()
+{
+  simEnsemble_t* ensemble = tunedEnsemble();
+  bool available = acquired && ensemble != nullptr && hostClock.now >= serviceListTime;
+
+  replyByte(0, eventInterrupts);
+  replyByte(1, available);
+  replyWord(2, available ? ensemble->version : 0);
+
+  //EVENT_ACK
+  if (command[1] & 1) eventInterrupts = 0;
+}
+
+void SimulatorSi468x::ensembleInfo()
+{
+  simEnsemble_t* ensemble = acquired ? tunedEnsemble() : nullptr;
+
+  replyWord(0, ensemble != nullptr ? ensemble->ensembleId : 0);
+  for (uint8_t i = 0; i < 16; i++)
+  {
+    char ch = ' ';
+    if (ensemble != nullptr && i < strlen(ensemble->label)) ch = ensemble->label[i];
+    replyByte(2 + i, ch);
+  }
+  replyByte(18, ensemble != nullptr ? ensemble->ecc : 0);
+  replyByte(19, 0);
+  replyWord(20, 0xF000);
+}
+
+//Services of serviceType, 24 Bytes per service and 4 bytes per component
+void SimulatorSi468x::serviceList()
+{
+  simEnsemble_t* ensemble = tunedEnsemble();
+  uint8_t dataFlag = command[1] & 1;
+
+  //list header, empty until service list is available
+  replyWord(0, 0);
+  replyWord(2, 0);
+  replyLong(4, 0);
+
+  if (!acquired || ensemble == nullptr || hostClock.now < serviceListTime) return;
+
+  uint16_t position = 8;
+  uint8_t numServices = 0;
+  for (uint8_t i = 0; i < ensemble->numServices; i++)
+  {
+    simService_t& service = ensemble->services[i];
+    if (service.dataFlag != dataFlag) continue;
+
+    replyLong(position, service.serviceId);
+    replyByte(position + 4, service.programType << 1 | service.dataFlag);
+    replyByte(position + 5, service.numComponents);
+    replyByte(position + 6, 0);//EBU Latin
+    replyByte(position + 7, 0);
+    for (uint8_t j = 0; j < 16; j++) replyByte(position + 8 + j, j < strlen(service.label) ? service.label[j] : ' ');
+    position += 24;
+
+    for (uint8_t j = 0; j < service.numComponents; j++)
+    {
+      replyWord(position, service.components[j].componentId);
+      replyByte(position + 2, service.components[j].componentType << 2);
+      replyByte(position + 3, 1);
+      position += 4;
+    }
+    numServices++;
+  }
+
+  //list size without 2 bytes of size
+  replyWord(0, position - 2);
+  replyWord(2, ensemble->version);
+  replyByte(4, numServices);
+
+  readyTime += position;
+}
+
+simService_t* SimulatorSi468x::findService(uint32_t serviceId)
+{
+  simEnsemble_t* ensemble = acquired ? tunedEnsemble() : nullptr;
+
+  for (uint8_t i = 0; ensemble != nullptr && i < ensemble->numServices; i++)
+  {
+    if (ensemble->services[i].serviceId == serviceId) return &ensemble->services[i];
+  }
+  return nullptr;
+}
+
+simComponent_t* SimulatorSi468x::findComponent(uint32_t serviceId, uint32_t componentId)
+{
+  simService_t* service = findService(serviceId);
+
+  for (uint8_t j = 0; service != nullptr && j < service->numComponents; j++)
+  {
+    if (service->components[j].componentId == componentId) return &service->components[j];
+  }
+  return nullptr;
+}
+
+//START_DIGITAL_SERVICE and STOP_DIGITAL_SERVICE, one audio service runs
+void SimulatorSi468x::startService(bool start)
+{
+  if (lenCommand < 12)
+  {
+    replyError(SIM_ERROR_BAD_ARGUMENT);
+    return;
+  }
+  uint32_t serviceId = (uint32_t)command[7] << 24 | (uint32_t)command[6] << 16 | (uint32_t)command[5] << 8 | command[4];
+  uint32_t componentId = (uint32_t)command[11] << 24 | (uint32_t)command[10] << 16 | (uint32_t)command[9] << 8 | command[8];
+
+  if (!acquired)
+  {
+    replyError(SIM_ERROR_NOT_ACQUIRED);
+    return;
+  }
+  if (findComponent(serviceId, componentId) == nullptr)
+  {
+    replyError(SIM_ERROR_NO_SERVICE);
+    return;
+  }
+
+  if (!start)
+  {
+    if (serviceRunning && runningServiceId == serviceId && runningComponentId == componentId) serviceRunning = false;
+    return;
+  }
+
+  serviceRunning = true;
+  runningServiceId = serviceId;
+  runningComponentId = componentId;
+  nextDlsTime = readyTime + SIM_DLS_PERIOD * 500ULL;
+  dlsSize = 0;
+  dsrvOverflow = false;
+}
+
+//DLS packet of running service into DSRV queue, overflow if full
+void SimulatorSi468x::queueDls()
+{
+  if (dlsSize == SIM_DSRV_QUEUE)
+  {
+    dsrvOverflow = true;
+    return;
+  }
+
+  simService_t* service = findService(runningServiceId);
+  dlsCount++;
+  snprintf(dlsQueue[(dlsHead + dlsSize) % SIM_DSRV_QUEUE], SIM_DLS_SIZE, "%s - Title %u", service != nullptr ? service->label : "", dlsCount);
+  dlsSize++;
+}
+
+//Header and payload of oldest packet, removed unless STATUS_ONLY, ACK clears interrupts
+void SimulatorSi468x::serviceData()
+{
+  uint8_t statusOnly = command[1] >> 4 & 1;
+  uint8_t ack = command[1] & 1;
+
+  replyByte(0, dsrvOverflow << 1 | (dlsSize != 0));
+  replyByte(1, dlsSize);
+  replyByte(2, 0);
+  replyWord(14, 0);
+  replyLong(16, 0);
+
+  if (ack) dsrvOverflow = false;
+  if (dlsSize == 0) return;
+
+  const char* dls = dlsQueue[dlsHead];
+  uint16_t len = strlen(dls);
+
+  replyByte(2, 3);//beginning of data object
+  replyByte(3, 2 << 6);//DLS PAD
+  replyLong(4, runningServiceId);
+  replyLong(8, runningComponentId);
+  replyWord(12, 0);
+  //prefix of DLS, text with '\0'
+  replyWord(14, 2 + len + 1);
+  replyWord(16, 0);
+  replyWord(18, 1);
+  replyByte(20, (dlsCount & 1) << 7);
+  replyByte(21, 0);
+  for (uint16_t i = 0; i <= len; i++) replyByte(22 + i, dls[i]);
+
+  if (!statusOnly)
+  {
+    dlsHead = (dlsHead + 1) % SIM_DSRV_QUEUE;
+    dlsSize--;
+  }
+}
+
+void SimulatorSi468x::serviceInfo()
+{
+  uint32_t serviceId = (uint32_t)command[7] << 24 | (uint32_t)command[6] << 16 | (uint32_t)command[5] << 8 | command[4];
+  simService_t* service = lenCommand < 8 ? nullptr : findService(serviceId);
+  if (service == nullptr)
+  {
+    replyError(SIM_ERROR_NO_SERVICE);
+    return;
+  }
+
+  replyByte(0, service->programType << 1 | service->dataFlag);
+  replyByte(1, service->numComponents);
+  replyByte(2, 0);
+  replyByte(3, tunedEnsemble()->ecc);
+  for (uint8_t j = 0; j < 16; j++) replyByte(4 + j, j < strlen(service->label) ? service->label[j] : ' ');
+  replyWord(20, 0xFF00);
+}
+
+void SimulatorSi468x::subchannelInfo()
+{
+  uint32_t serviceId = (uint32_t)command[7] << 24 | (uint32_t)command[6] << 16 | (uint32_t)command[5] << 8 | command[4];
+  uint32_t componentId = (uint32_t)command[11] << 24 | (uint32_t)command[10] << 16 | (uint32_t)command[9] << 8 | command[8];
+  simComponent_t* component = lenCommand < 12 ? nullptr : findComponent(serviceId, componentId);
+  if (component == nullptr)
+  {
+    replyError(SIM_ERROR_NO_SERVICE);
+    return;
+  }
+
+  replyByte(0, component->serviceMode);
+  replyByte(1, component->protectionInfo);
+  replyWord(2, component->bitRate);
+  replyWord(4, component->numberCU);
+  replyWord(6, component->addressCU);
+}
+
+void SimulatorSi468x::componentInfo()
+{
+  uint32_t serviceId = (uint32_t)command[7] << 24 | (uint32_t)command[6] << 16 | (uint32_t)command[5] << 8 | command[4];
+  uint32_t componentId = (uint32_t)command[11] << 24 | (uint32_t)command[10] << 16 | (uint32_t)command[9] << 8 | command[8];
+  simService_t* service = lenCommand < 12 ? nullptr : findService(serviceId);
+  if (service == nullptr || findComponent(serviceId, componentId) == nullptr)
+  {
+    replyError(SIM_ERROR_NO_SERVICE);
+    return;
+  }
+
+  replyByte(0, 0);
+  replyByte(2, 0);
+  replyByte(3, 0);
+  for (uint8_t j = 0; j < 16; j++) replyByte(4 + j, j < strlen(service->label) ? service->label[j] : ' ');
+  replyWord(20, 0xFF00);
+  //one user application, slideshow
+  replyByte(22, 1);
+  replyByte(23, 4);
+  replyWord(24, 0x0002);
+  replyByte(26, 2);
+  replyByte(27, 0);
+  replyWord(28, 0);
+}
+
+void SimulatorSi468x::setFrequencyList()
+{
+  uint8_t number = command[1];
+  if (number == 0 || number > MAX_INDEX || lenCommand < 4 + 4 * number)
+  {
+    replyError(SIM_ERROR_BAD_ARGUMENT);
+    return;
+  }
+
+  for (uint8_t i = 0; i < number; i++)
+  {
+    uint32_t frequency = (uint32_t)command[7 + 4 * i] << 24 | (uint32_t)command[6 + 4 * i] << 16 | (uint32_t)command[5 + 4 * i] << 8 | command[4 + 4 * i];
+    if (frequency < 168160 || frequency > 239200)
+    {
+      replyError(SIM_ERROR_BAD_ARGUMENT);
+      return;
+    }
+  }
+
+  numFrequencies = number;
+  for (uint8_t i = 0; i < number; i++)
+  {
+    frequencies[i] = (uint32_t)command[7 + 4 * i] << 24 | (uint32_t)command[6 + 4 * i] << 16 | (uint32_t)command[5 + 4 * i] << 8 | command[4 + 4 * i];
+  }
+  if (tunedIndex >= numFrequencies) tunedIndex = 0;
+}
+
+void SimulatorSi468x::getFrequencyList()
+{
+  replyByte(0, numFrequencies);
+  replyByte(1, 0);
+  replyWord(2, 0);
+  for (uint8_t i = 0; i < numFrequencies; i++) replyLong(4 + 4 * i, frequencies[i]);
+}
+
+void SimulatorSi468x::audioInfo()
+{
+  simComponent_t* component = serviceRunning ? findComponent(runningServiceId, runningComponentId) : nullptr;
+
+  replyWord(0, component != nullptr ? component->bitRate : 0);
+  replyWord(2, component != nullptr ? 48000 : 0);
+  //SBR, stereo
+  replyByte(4, component != nullptr ? 1 << 1 : 0);
+  replyByte(5, 0);
+}
+
+//Ensemble time from 2026-10-16 12:00:00 on
+void SimulatorSi468x::dateTime()
+{
+  if (!acquired)
+  {
+    replyError(SIM_ERROR_NOT_ACQUIRED);
+    return;
+  }
+
+  unsigned long seconds = hostClock.now / 1000000;
+
+  replyWord(0, 2026);
+  replyByte(2, 10);
+  replyByte(3, 16 + (12 + seconds / 3600) / 24);
+  replyByte(4, (12 + seconds / 3600) % 24);
+  replyByte(5, seconds / 60 % 60);
+  replyByte(6, seconds % 60);
+}
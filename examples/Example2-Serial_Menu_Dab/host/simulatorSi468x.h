@@ -0,0 +1,251 @@
+//include guard
+#ifndef SIMULATOR_SI468X_H
+#define SIMULATOR_SI468X_H
+
+/*
+  Behavioral simulator of tuner circuit Si468x for the host build
+
+  Command interface over SPI like the device:
+  - bootloader with POWER_UP, LOAD_INIT, HOST_LOAD, FLASH_LOAD and BOOT, image is checked with CRC32 of firmware.h
+  - CTS after a latency per command, command while busy sets CMDOFERR and is dropped
+  - reply buffer stays intact until next command, READ_OFFSET reads it from an offset
+  - properties with defaults after BOOT, INT_CTL_ENABLE selects sources of INTB
+  - frequency table, DAB_TUNE_FREQ with STCINT after acquisition, fast detect and signal quality per index
+  - ensembles with service list, version, reconfiguration, sub-channels in CIF and DLS packets of running service
+
+  Latencies are assumptions in the order of AN649 and measurements with the shield, not exact values.
+  Error codes are the ones of the simulator, the driver prints them only.
+*/
+
+//Arduino stand-in, simulated clock
+#include "Arduino.h"
+
+//Opcodes, channels and firmware images of driver
+#include "SI468x.h"
+
+enum simulatorLimits_t
+{
+  SIM_REPLY_SIZE      = 0x1000,
+  SIM_COMMAND_SIZE    = 0x1000 + 16,//HOST_LOAD with 4 kB
+  SIM_MAX_PROPERTIES  = 64,
+  SIM_MAX_ENSEMBLES   = 8,
+  SIM_MAX_SERVICES    = 32,
+  SIM_MAX_COMPONENTS  = 2,
+  SIM_DSRV_QUEUE      = 8,//Maximum DSRV queue depth of Si468x
+  SIM_DLS_SIZE        = 64,
+  SIM_STORAGE_SIZE    = 0x400,
+};
+
+enum simulatorError_t
+{
+  SIM_ERROR_BAD_COMMAND  = 0x10,//unknown opcode or not allowed in this state
+  SIM_ERROR_BAD_ARGUMENT = 0x11,
+  SIM_ERROR_BAD_PROPERTY = 0x20,
+  SIM_ERROR_NOT_ACQUIRED = 0x30,//no ensemble on tuned index
+  SIM_ERROR_NO_SERVICE   = 0x31,//service or component not in ensemble
+  SIM_ERROR_BAD_IMAGE    = 0x40,//BOOT of image with wrong CRC32 or without patch
+};
+
+//States of device, PUP_STATE of status
+enum simulatorState_t
+{
+  SIM_STATE_RESET       = 0,//waiting for POWER_UP
+  SIM_STATE_BOOTLOADER  = 2,
+  SIM_STATE_APPLICATION = 3,
+};
+
+//Component with own sub-channel in CIF
+struct simComponent_t
+{
+  uint16_t componentId;
+  uint8_t componentType;//ASCTy/DSCTy, 63 DAB+ audio
+  uint8_t serviceMode;//3 DAB+, 2 packet data
+  uint8_t protectionInfo;
+  uint16_t bitRate;
+  uint16_t addressCU;
+  uint16_t numberCU;
+};
+
+struct simService_t
+{
+  uint32_t serviceId;//with ECC if data service
+  char label[17];
+  uint8_t programType;
+  uint8_t dataFlag;
+  uint8_t numComponents;
+  simComponent_t components[SIM_MAX_COMPONENTS];
+};
+
+struct simEnsemble_t
+{
+  uint32_t frequency;
+  uint16_t ensembleId;
+  char label[17];
+  uint8_t ecc;
+  uint16_t version;//of service list
+  int8_t rssi;
+  int8_t snr;
+  uint8_t cnr;
+  uint8_t ficQuality;
+  uint8_t fastDect;
+  uint8_t acquires;//0 fast detect passes, acquisition fails
+  uint16_t usedCU;
+  uint8_t numServices;
+  simService_t services[SIM_MAX_SERVICES];
+};
+
+//Commands per opcode, waiting of host for CTS
+struct simCommandStatistics_t
+{
+  unsigned long commands;
+  unsigned long polls;//RD_REPLY until CTS was read
+  unsigned long unread;//next command before CTS was read
+  unsigned long long wait;//us from command until CTS was read
+  unsigned long long sleep;//us in delay() of host meanwhile
+  unsigned long long latency;//us until CTS of device
+};
+
+class SimulatorSi468x
+{
+  public:
+    SimulatorSi468x();
+
+    //SPI transfer of host, reply bytes are written into data
+    void transferSpi(uint8_t data[], uint32_t len, bool start, bool end);
+    //INTB asserted
+    bool readInterrupt();
+    //RSTB, low holds device in reset
+    void writeReset(uint8_t level);
+
+    //Firmware images of firmware.h with matching CRC32 into flash image
+    void writeFirmwareImages(uint8_t image[]);
+
+    //Ensembles on air
+    void removeEnsembles();
+    simEnsemble_t* addEnsemble(uint32_t frequency, uint16_t ensembleId, const char label[], int8_t rssi, int8_t snr);
+    simService_t* addService(simEnsemble_t* ensemble, uint32_t serviceId, const char label[], uint8_t programType, uint8_t dataFlag = 0);
+    void addComponent(simEnsemble_t* ensemble, simService_t* service, uint16_t componentId, uint16_t bitRate);
+    bool removeService(simEnsemble_t* ensemble, uint32_t serviceId);
+    simEnsemble_t* findEnsemble(uint32_t frequency);
+    //New version of service list, tuned ensemble signals reconfiguration
+    void reconfigure(simEnsemble_t* ensemble);
+
+    void clearStatistics();
+
+    //FLASH_LOAD reads flash memory, shield has no secondary SPI bus and reads 0xff
+    bool secondarySpi;
+
+    simCommandStatistics_t statistics[256];
+    unsigned long overflows;//commands while busy
+
+  private:
+    void update();
+    void execute();
+    void replyError(uint8_t code);
+    void replyByte(uint16_t position, uint8_t value);
+    void replyWord(uint16_t position, uint16_t value);
+    void replyLong(uint16_t position, uint32_t value);
+    uint8_t readStatus(uint8_t position);
+    bool readCommandWord(uint16_t position, uint16_t& value);
+    unsigned long latency(uint8_t opcode);
+
+    void powerUp();
+    void loadInit();
+    void hostLoad();
+    void flashLoad();
+    void boot();
+    void resetApplication();
+
+    uint16_t* findProperty(uint16_t id);
+    void setProperty();
+    void getProperty();
+    uint16_t readProperty(uint16_t id);
+
+    void tune();
+    void digradStatus();
+    void eventStatus();
+    void ensembleInfo();
+    void serviceList();
+    void startService(bool start);
+    void serviceData();
+    void serviceInfo();
+    void subchannelInfo();
+    void componentInfo();
+    void setFrequencyList();
+    void getFrequencyList();
+    void audioInfo();
+    void dateTime();
+    void queueDls();
+    simService_t* findService(uint32_t serviceId);
+    simComponent_t* findComponent(uint32_t serviceId, uint32_t componentId);
+    simEnsemble_t* tunedEnsemble();
+
+    //Command interface
+    uint8_t command[SIM_COMMAND_SIZE];
+    uint16_t lenCommand;
+    bool readingReply;
+    uint16_t positionReply;
+    uint8_t response[SIM_REPLY_SIZE];
+    uint16_t lenResponse;
+    uint16_t readOffset;
+
+    //Status
+    uint8_t state;
+    bool inReset;
+    bool cts;
+    bool ctsInterrupt;
+    bool error;
+    bool commandOverflow;
+    bool nonRecoverable;
+    unsigned long long readyTime;
+    uint8_t powerUpArguments[16];
+
+    //Statistics of actual command
+    uint8_t opcode;
+    bool waitingCts;
+    unsigned long polls;
+    unsigned long long commandTime;
+    unsigned long long commandSleep;
+
+    //Bootloader
+    uint32_t loadedSize;
+    uint32_t loadedCrc32;
+    bool patchLoaded;
+    bool booting;
+
+    //Application
+    uint16_t properties[SIM_MAX_PROPERTIES][2];
+    uint8_t numProperties;
+    uint32_t frequencies[MAX_INDEX];
+    uint8_t numFrequencies;
+    uint8_t storage[SIM_STORAGE_SIZE];
+
+    //Tuner
+    uint8_t tunedIndex;
+    bool tuning;
+    bool acquired;
+    uint8_t stcInterrupt;
+    uint8_t digradInterrupts;
+    unsigned long long stcTime;
+    unsigned long long serviceListTime;
+    bool serviceListSignalled;
+    uint8_t eventInterrupts;
+
+    //Running service and DLS packets
+    bool serviceRunning;
+    uint32_t runningServiceId;
+    uint32_t runningComponentId;
+    unsigned long long nextDlsTime;
+    uint16_t dlsCount;
+    char dlsQueue[SIM_DSRV_QUEUE][SIM_DLS_SIZE];
+    uint8_t dlsHead;
+    uint8_t dlsSize;
+    bool dsrvOverflow;
+
+    simEnsemble_t ensembles[SIM_MAX_ENSEMBLES];
+    uint8_t numEnsembles;
+};
+
+extern SimulatorSi468x simulatorSi468x;
+
+#endif //SIMULATOR_SI468X_H
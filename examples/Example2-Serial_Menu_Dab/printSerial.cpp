@@ -152,6 +152,54 @@ void printPowerUpArguments(powerUpArguments_t& powerUpArguments)
   Serial.println();
 }
 
+//Print statistics of last readReply()
+void printReplyStatistics(replyStatistics_t& replyStatistics)
+{
+  Serial.println(F("Reply Statistics"));
+  Serial.print(F("Polls:\t\t"));
+  Serial.println(replyStatistics.polls);
+  Serial.print(F("Interrupt:\t"));
+  Serial.println(replyStatistics.interrupt);
+  Serial.print(F("Wait Time:\t"));
+  Serial.print(replyStatistics.duration);
+  Serial.println(F(" us"));
+  Serial.println();
+}
+
+//Print boot mode and duration of firmware load
+void printBootInformation(unsigned char bootMode, loadStatistics_t& loadStatistics)
+{
+  Serial.print(F("Boot Mode:\t"));
+  if (bootMode == BOOT_FLASH_LOAD) Serial.println(F("Flash Load"));
+  else Serial.println(F("Host Load"));
+  Serial.print(F("Load Time:\t"));
+  Serial.print(loadStatistics.duration);
+  Serial.println(F(" ms"));
+  Serial.print(F("Throughput:\t"));
+  Serial.print(loadStatistics.throughput);
+  Serial.println(F(" Bytes/s"));
+  Serial.print(F("Package Size:\t"));
+  Serial.println(loadStatistics.packageSize);
+  Serial.println();
+}
+
+//Print result and CRC32 throughput of firmware verification
+void printVerifyFirmware(const char name[], bool valid, unsigned long size, unsigned long duration)
+{
+  Serial.println(name);
+  Serial.print(F("CRC32:\t\t"));
+  if (valid) Serial.println(F("ok"));
+  else Serial.println(F("failed"));
+  Serial.print(F("Verify Time:\t"));
+  Serial.print(duration);
+  Serial.println(F(" ms"));
+  Serial.print(F("Throughput:\t"));
+  if (duration != 0) Serial.print(size * 1000UL / duration);
+  else Serial.print(0);
+  Serial.println(F(" Bytes/s"));
+  Serial.println();
+}
+
 //Print Rssi Information In 8.8 Format
 void printRssi(unsigned short rssi)
 {
@@ -181,6 +229,18 @@ void printPropertyValueList(unsigned short propertyValueList[][2], unsigned char
   Serial.println();
 }
 
+//Print statistics of last property list write
+void printPropertyStatistics(propertyStatistics_t& propertyStatistics)
+{
+  Serial.print(F("Properties written:\t"));
+  Serial.print(propertyStatistics.written);
+  Serial.print(F("\tskipped:\t"));
+  Serial.print(propertyStatistics.skipped);
+  Serial.print(F("\tTime:\t"));
+  Serial.print(propertyStatistics.duration);
+  Serial.println(F(" ms"));
+}
+
 void printResponseHex(unsigned char response[], unsigned long len)
 {
   if (len == 0) return;
@@ -445,15 +505,23 @@ void dabPrintIndex(unsigned char index)
 }
 
 //Print frequency list
-void dabPrintFrequencyTable(frequencyTableHeader_t frequencyTableHeader)
+void dabPrintFrequencyTable(const frequencyTableHeader_t& frequencyTableHeader)
 {
   char string[20];
   Serial.println(F("Frequency List"));
 
-  for (unsigned char i = 0; i < frequencyTableHeader.number; i++)
+  //frequencies are not cached, only on stack while printed
+  uint32_t frequencies[FREQ_TABLE_CHUNK];
+  for (unsigned char i = 0; i < frequencyTableHeader.number; i += FREQ_TABLE_CHUNK)
   {
-    snprintf(string, 20, "%2u : %6lu kHz", i , frequencyTableHeader.table[i]) ;
-    Serial.println(string);
+    unsigned char len = frequencyTableHeader.number - i < FREQ_TABLE_CHUNK ? frequencyTableHeader.number - i : (unsigned char)FREQ_TABLE_CHUNK;
+    if (!readFrequencies(frequencies, i, len)) break;
+
+    for (unsigned char j = 0; j < len; j++)
+    {
+      snprintf(string, 20, "%2u : %6lu kHz", i + j, (unsigned long) frequencies[j]) ;
+      Serial.println(string);
+    }
   }
   Serial.println();
 }
@@ -468,7 +536,7 @@ void dabPrintIndexList(const indexListHeader_t& indexListHeader)
   else
   {
     char string[11];
-    Serial.println(F("Index List"));
+    Serial.println(F("Index List, best first"));
     for (unsigned char i = 0; i < indexListHeader.size; i++)
     {
       Serial.print(F("Number: "));
@@ -476,13 +544,54 @@ void dabPrintIndexList(const indexListHeader_t& indexListHeader)
       Serial.print(F("\tIndex: "));
       Serial.print(indexListHeader.indexList[i].index);
       Serial.print(F("\tFrequency: "));
-      snprintf(string, 11, "%6lu kHz", indexListHeader.indexList[i].frequency) ;
+      snprintf(string, 11, "%6lu kHz", (unsigned long) indexListHeader.indexList[i].frequency) ;
       Serial.println(string);
+      Serial.print(F("RSSI: "));
+      Serial.print(indexListHeader.indexList[i].rssi);
+      Serial.print(F("\tSNR: "));
+      Serial.print(indexListHeader.indexList[i].snr);
+      Serial.print(F("\tCNR: "));
+      Serial.print(indexListHeader.indexList[i].cnr);
+      Serial.print(F("\tFIC Quality: "));
+      Serial.print(indexListHeader.indexList[i].ficQuality);
+      Serial.print(F("\tFast Detect: "));
+      Serial.print(indexListHeader.indexList[i].fastDect);
+      Serial.print(F("\tScore: "));
+      Serial.println(indexListHeader.indexList[i].score);
     }
   }
   Serial.println();
 }
 
+//Print latency of last tune
+void dabPrintTuneStatistics(tuneStatistics_t& tuneStatistics)
+{
+  Serial.print(F("Tune Index:\t"));
+  Serial.print(tuneStatistics.index);
+  Serial.print(F("\tLatency ms:\t"));
+  Serial.print(tuneStatistics.latency);
+  Serial.print(F("\tSTC:\t"));
+  Serial.print(tuneStatistics.complete);
+  Serial.print(F("\tINTB:\t"));
+  Serial.println(tuneStatistics.interrupt);
+}
+
+//Print phases and duration of last bandscan
+void dabPrintScanStatistics(scanStatistics_t& scanStatistics)
+{
+  Serial.print(F("Scan Indices:\t"));
+  Serial.print(scanStatistics.indices);
+  Serial.print(F("\tCandidates:\t"));
+  Serial.print(scanStatistics.candidates);
+  Serial.print(F("\tValid:\t"));
+  Serial.println(scanStatistics.valid);
+  Serial.print(F("Fast Detect ms:\t"));
+  Serial.print(scanStatistics.durationFast);
+  Serial.print(F("\tFull Acquisition ms:\t"));
+  Serial.println(scanStatistics.durationFull);
+  Serial.println();
+}
+
 //Prints information about the digital service
 void dabPrintDigitalServiceInformation(serviceInformation_t& dabServiceInfo)
 {
@@ -533,23 +642,164 @@ void dabPrintEnsemble(ensembleHeader_t& ensembleHeader)
     //Serial.print(F("Service:\t"));
     //Serial.println(serviceNum);
     Serial.print(F("Service Id:\t0x"));
-    Serial.print(ensembleHeader.serviceList[serviceNum].serviceId, HEX);
+    Serial.print(getServiceId(serviceNum), HEX);
     Serial.print(F("\tData Flag:\t"));
-    Serial.println(ensembleHeader.serviceList[serviceNum].dataFlag);
+    Serial.println(getDataFlag(serviceNum));
+    Serial.print(F("Service Label:\t"));
+    const char* label = getServiceLabel(serviceNum);
+    if (label != nullptr) Serial.print(label);
+    Serial.print(F("\tPTY:\t"));
+    Serial.print(getProgramType(serviceNum));
+    Serial.print(F("\tChar. Set:\t"));
+    Serial.println(getCharacterSet(serviceNum));
     Serial.print(F("Number of Components:\t"));
-    Serial.println(ensembleHeader.serviceList[serviceNum].numComponents);
-    for (unsigned char componentNum = 0; componentNum < ensembleHeader.serviceList[serviceNum].numComponents; componentNum++)
+    Serial.println(getNumComponents(serviceNum));
+    for (unsigned char componentNum = 0; componentNum < getNumComponents(serviceNum); componentNum++)
     {
       Serial.print(F("Component Id:\t0x"));
-      Serial.print(ensembleHeader.serviceList[serviceNum].componentList[componentNum].componentId, HEX);
+      Serial.print(getComponentId(serviceNum, componentNum), HEX);
       Serial.print(F("\tService Type:\t"));
-      Serial.println(ensembleHeader.serviceList[serviceNum].componentList[componentNum].serviceType);
+      Serial.println(getComponentType(serviceNum, componentNum));
     }
     Serial.println();
   }
   Serial.println();
 }
 
+//Print usage and high water mark of ensemble arena
+void dabPrintEnsembleArena(ensembleArena_t& ensembleArena)
+{
+  Serial.print(F("Arena Services:\t"));
+  Serial.print(ensembleArena.maxServices);
+  Serial.print(F(" / "));
+  Serial.println(MAX_NUMBER_SERVICES);
+  Serial.print(F("Arena Components:\t"));
+  Serial.print(ensembleArena.numComponents);
+  Serial.print(F(" (max "));
+  Serial.print(ensembleArena.maxComponents);
+  Serial.print(F(") / "));
+  Serial.println(MAX_ARENA_COMPONENTS);
+#ifdef DAB_LABEL_POOL
+  Serial.print(F("Arena Labels:\t"));
+  Serial.print(ensembleArena.lenLabels);
+  Serial.print(F(" / "));
+  Serial.println(LABEL_POOL_SIZE);
+#endif
+  Serial.print(F("Arena Long SIds:\t"));
+  Serial.print(ensembleArena.numLongServiceIds);
+  Serial.print(F(" / "));
+  Serial.println(MAX_LONG_SERVICE_IDS);
+  //sizeof report of struct of arrays
+  Serial.print(F("Bytes Services:\t"));
+  Serial.print(sizeof(ensembleArena.serviceIds) + sizeof(ensembleArena.serviceInfo) + sizeof(ensembleArena.serviceComponents)
+               + sizeof(ensembleArena.firstComponent) + sizeof(ensembleArena.order));
+  Serial.print(F("\tLong SIds:\t"));
+  Serial.println(sizeof(ensembleArena.longServiceIds) + sizeof(ensembleArena.numLongServiceIds));
+  Serial.print(F("Bytes Components:\t"));
+  Serial.print(sizeof(ensembleArena.componentIds) + sizeof(ensembleArena.componentInfo));
+  Serial.print(F("\tLabels:\t"));
+#ifdef DAB_LABEL_POOL
+  Serial.println(sizeof(ensembleArena.labels) + sizeof(ensembleArena.serviceLabels) + sizeof(ensembleArena.lenLabels));
+#else
+  Serial.println(0);
+#endif
+  Serial.print(F("Arena Bytes:\t"));
+  Serial.println(sizeof(ensembleArena_t));
+  Serial.println();
+}
+
+//Print key and hits of ensemble cache
+void dabPrintEnsembleCache(ensembleCache_t& ensembleCache)
+{
+  Serial.print(F("Cache Ensemble Id:\t0x"));
+  Serial.print(ensembleCache.ensembleId, HEX);
+  Serial.print(F("\tVersion:\t"));
+  Serial.print(ensembleCache.version);
+  Serial.print(F("\tValid:\t"));
+  Serial.print(ensembleCache.valid);
+  Serial.print(F("\tSnapshot:\t"));
+  Serial.println(ensembleCache.snapshot);
+  Serial.print(F("Cache Hits:\t"));
+  Serial.print(ensembleCache.hits);
+  Serial.print(F("\tMisses:\t"));
+  Serial.println(ensembleCache.misses);
+  Serial.println();
+}
+
+//Print valid entries of service directory
+void dabPrintServiceDirectory(serviceDirectory_t& serviceDirectory)
+{
+  Serial.print(F("Service Directory:\t"));
+  Serial.print(serviceDirectory.size);
+  Serial.print(F(" / "));
+  Serial.print(MAX_DIRECTORY_KEYS);
+  Serial.print(F("\tSlots:\t"));
+  Serial.print(serviceDirectory.count);
+  Serial.print(F(" / "));
+  Serial.print(DIRECTORY_ENTRIES);
+  Serial.print(F("\tSector:\t"));
+  Serial.println(serviceDirectory.sector);
+
+  directoryEntry_t entry;
+  for (unsigned char k = 0; k < serviceDirectory.size; k++)
+  {
+    if (!readDirectoryEntry(serviceDirectory.keys[k].slot, entry)) continue;
+
+    Serial.print(F("Index:\t"));
+    Serial.print(entry.index);
+    Serial.print(F("\tEnsemble Id:\t0x"));
+    Serial.print(entry.ensembleId, HEX);
+    Serial.print(F("\tService Id:\t0x"));
+    Serial.print(entry.serviceId, HEX);
+    Serial.print(F("\tComponent Id:\t0x"));
+    Serial.print(entry.componentId, HEX);
+    Serial.print(F("\tPTY:\t"));
+    Serial.print(entry.programType);
+    Serial.print(F("\t"));
+    Serial.println(entry.label);
+  }
+  Serial.println();
+}
+
+//Print difference of service list after reconfiguration
+void dabPrintEnsembleDiff(ensembleDiff_t& ensembleDiff)
+{
+  Serial.println(F("Reconfiguration"));
+  Serial.print(F("Services Added:\t"));
+  Serial.print(ensembleDiff.added);
+  Serial.print(F("\tRemoved:\t"));
+  Serial.print(ensembleDiff.removed);
+  Serial.print(F("\tChanged:\t"));
+  Serial.println(ensembleDiff.changed);
+  Serial.print(F("Service Kept:\t"));
+  Serial.println(ensembleDiff.serviceKept);
+  Serial.println();
+}
+
+//Print CIF map as CSV
+void dabPrintCifMap(cifMap_t& cifMap)
+{
+  char string[40];
+
+  Serial.println(F("startCU,numberCU,bitRate,protection,serviceMode,components"));
+  for (unsigned char k = 0; k < cifMap.size; k++)
+  {
+    subchannel_t& subchannel = cifMap.subchannels[k];
+    snprintf(string, sizeof(string), "%u,%u,%u,%u,%u,%u", subchannel.addressCU, subchannel.numberCU, subchannel.bitRate,
+             subchannel.protectionInfo, subchannel.serviceMode, subchannel.components);
+    Serial.println(string);
+  }
+  Serial.print(F("freeCU,"));
+  Serial.println(cifMap.freeCU);
+  Serial.print(F("overlaps,"));
+  Serial.println(cifMap.overlaps);
+  Serial.print(F("dropped,"));
+  Serial.println(cifMap.dropped);
+  Serial.print(F("cuLevel,"));
+  Serial.println(cifMap.cuLevel);
+  Serial.println();
+}
+
 //Print component technical information
 void dabPrintComponentTechnicalInformation(componentTechnicalInformation_t& componentTechnicalInformation)
 {
@@ -659,6 +909,10 @@ void printError(unsigned char errorCode)
     Serial.println(F("No Service"));
   else if (errorCode == 10)
     Serial.println(F("Memory Allocation"));
+  else if (errorCode == 11)
+    Serial.println(F("Firmware CRC32"));
+  else if (errorCode == 12)
+    Serial.println(F("Boot"));
   else
     Serial.println(F("Unknown"));
   Serial.println();
@@ -699,6 +953,7 @@ void dabPrintMenuMain()
   Serial.println(F("3: Favorite 3"));
   Serial.println(F("4: Favorite 4"));
   Serial.println(F("5: Favorite 5"));
+  Serial.println(F("j: Next Service Directory"));
   Serial.println(F("x: Start Service"));
   Serial.println(F("y: Stop Service"));
 
@@ -724,6 +979,7 @@ void dabPrintMenuTechnical()
   Serial.println(F("R: RSSI"));
   Serial.println(F("W: Front End Switch"));
   Serial.println(F("p: Properties DAB"));
+  Serial.println(F("c: CIF Map CSV"));
   Serial.println();
 }
 
@@ -743,6 +999,8 @@ void dabPrintMenuScanFrequency()
   Serial.println();
   Serial.println(F("s: Index Bandscan"));
   Serial.println(F("i: Index Valid List"));
+  Serial.println(F("S: Scan Service Directory"));
+  Serial.println(F("g: Service Directory"));
   Serial.println(F("+: Index Valid Up:"));
   Serial.println(F("-: Index Valid Down"));
   Serial.println();
@@ -755,6 +1013,7 @@ void printMenuScanEnsemble()
   Serial.println(F("e: Ensemble Information"));
   Serial.println(F("h: Header Ensemble"));
   Serial.println(F("p: Parse Ensemble"));
+  Serial.println(F("u: Update Reconfiguration"));
   Serial.println(F("r: Info Service"));
   Serial.println(F("0: Start 1st Service"));
   Serial.println();
@@ -778,8 +1037,12 @@ void dabPrintMenuDevice()
   Serial.println(F("i: Firmware Info"));
   Serial.println(F("s: Status"));
   Serial.println(F("p: Properties"));
+  Serial.println(F("c: Reply Statistics"));
+  Serial.println(F("o: Resync Properties"));
   Serial.println(F("d: Power Down"));
   Serial.println(F("u: Power Up"));
+  Serial.println(F("w: Verify Firmware"));
+  Serial.println(F("b: Boot Mode Flash/Host"));
   Serial.println(F("6: Boot DAB"));
   Serial.println();
 }
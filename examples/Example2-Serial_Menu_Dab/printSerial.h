@@ -35,9 +35,13 @@ void printPartInfo(partInfo_t& partInfo);
 void printSystemState(unsigned char systemState);
 void printFirmwareInformation(firmwareInformation_t& firmwareInformation);
 void printPowerUpArguments(powerUpArguments_t& powerUpArguments);
+void printReplyStatistics(replyStatistics_t& replyStatistics);
+void printBootInformation(unsigned char bootMode, loadStatistics_t& loadStatistics);
+void printVerifyFirmware(const char name[], bool valid, unsigned long size, unsigned long duration);
 
 void printPropertyValue(unsigned short id, unsigned short value);
 void printPropertyValueList(unsigned short propertyValueList[][2], unsigned char numberProperties);
+void printPropertyStatistics(propertyStatistics_t& propertyStatistics);
 
 void printRssi(unsigned short rssi);
 void printResponseHex(unsigned char response[], unsigned long len);
@@ -54,6 +58,16 @@ void dabPrintDigitalServiceInformation(serviceInformation_t& dabServiceInfo);
 void dabPrintEnsembleHeader(ensembleHeader_t& ensembleHeader);
 //Print ensemble
 void dabPrintEnsemble(ensembleHeader_t& ensembleHeader);
+//Print usage and high water mark of ensemble arena
+void dabPrintEnsembleArena(ensembleArena_t& ensembleArena);
+//Print key and hits of ensemble cache
+void dabPrintEnsembleCache(ensembleCache_t& ensembleCache);
+//Print valid entries of service directory
+void dabPrintServiceDirectory(serviceDirectory_t& serviceDirectory);
+//Print difference of service list after reconfiguration
+void dabPrintEnsembleDiff(ensembleDiff_t& ensembleDiff);
+//Print CIF map as CSV
+void dabPrintCifMap(cifMap_t& cifMap);
 //Print status information of the digital ensemble
 void dabPrintEnsembleInformation(ensembleInformation_t& ensembleInformation);
 //Print event information about the various events related to the DAB radio
@@ -70,10 +84,14 @@ void printComponentInformation(componentInformation_t& componentInformation);
 //Print Service ID and Component ID
 void dabPrintIds(unsigned long serviceId, unsigned long componentId);
 //Print frequency list
-void dabPrintFrequencyTable(frequencyTableHeader_t frequencyTableHeader);
+void dabPrintFrequencyTable(const frequencyTableHeader_t& frequencyTableHeader);
 
 //Print index list
 void dabPrintIndexList(const indexListHeader_t& indexListHeader);
+//Print latency of last tune
+void dabPrintTuneStatistics(tuneStatistics_t& tuneStatistics);
+//Print phases and duration of last bandscan
+void dabPrintScanStatistics(scanStatistics_t& scanStatistics);
 
 //Print index
 void dabPrintIndex(unsigned char index);